@@ -3,15 +3,14 @@
 #include <string>
 #include <array>
 #include <algorithm>
-#include <unordered_map>
+#include <vector>
 
 #include "utils.h"
 
 constexpr int LINES = 1000;
 using Nums = std::pair<std::array<int, LINES>, std::array<int, LINES>>;
 
-Nums parseNums() {
-  std::ifstream ifs("input.txt");
+Nums parseNums(std::ifstream &ifs) {
   Nums ret;
   std::string line;
   for (int i = 0; std::getline(ifs, line) && i < LINES; ++i) {
@@ -34,21 +33,34 @@ void solvePart1(const Nums& nums) {
 }
 
 void solvePart2(const Nums& nums) {
-  std::unordered_map<int, int> occurrences;
+  FlatHashMap<int, int> occurrences;
+  occurrences.reserve(LINES);
   for (auto n : nums.second) {
     ++occurrences[n];
   }
   int sum = 0;
   for (auto n : nums.first) {
-    sum += n * occurrences[n];
+    if (const int *count = occurrences.find(n)) {
+      sum += n * *count;
+    }
   }
   std::cout << sum << "\n";
 }
 
+#ifdef AOC_RUNNER
+AOC_REGISTER(1, 1, [](std::ifstream &ifs) { solvePart1(parseNums(ifs)); });
+AOC_REGISTER(1, 2, [](std::ifstream &ifs) { solvePart2(parseNums(ifs)); });
+#else
 int main() {
-  const auto nums = parseNums();
+  std::ifstream ifs("input.txt");
+  const auto nums = parseNums(ifs);
   measureTime([&nums]() { solvePart1(nums); }, "Part 1");
   measureTime([&nums]() { solvePart2(nums); }, "Part 2");
+  if (benchmarkEnabled()) {
+    const std::vector<int> keys(nums.second.begin(), nums.second.end());
+    benchmarkHashMaps(keys, "int keys");
+  }
   std::cout << "Done.\n";
   return 0;
-}
\ No newline at end of file
+}
+#endif
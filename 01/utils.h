@@ -1,8 +1,21 @@
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
 #include <iomanip>
 #include <iostream>
+#include <streambuf>
+#include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 // This file is copied into each day.
 // That is redundant but this way I can still run older solutions without having
 // to touch them when I make changes in the utils.h.
@@ -57,6 +70,118 @@ inline bool operator==(const Coords_<T> &lhs, const Coords_<T> &rhs) {
 
 inline bool isDigit(char ch) { return 0x30 <= ch && ch < 0x3A; }
 
+// Benchmark mode.
+// Enable it by setting the environment variable AOC_BENCH, e.g.:
+// AOC_BENCH=1 ./solve
+// measureTime() then follows up its normal run with a proper benchmark of the
+// same function and prints the statistics in readable form plus as one JSON
+// line per measurement so that results can be collected across commits.
+inline bool benchmarkEnabled() { return std::getenv("AOC_BENCH") != nullptr; }
+
+// Swallows everything written to it.
+class NullBuffer : public std::streambuf {
+protected:
+  int overflow(int ch) override { return ch; }
+  std::streamsize xsputn(const char *, std::streamsize n) override { return n; }
+};
+
+// Keeps the output of the solutions out of the timed runs.
+class SuppressOutput {
+public:
+  SuppressOutput() : prevBuffer(std::cout.rdbuf(&nullBuffer)) {}
+  ~SuppressOutput() { std::cout.rdbuf(prevBuffer); }
+
+private:
+  NullBuffer nullBuffer;
+  std::streambuf *prevBuffer;
+};
+
+struct BenchmarkResult {
+  int runs = 0;
+  double minMs = 0.0;
+  double medianMs = 0.0;
+  double meanMs = 0.0;
+  double p99Ms = 0.0;
+  double stddevMs = 0.0;
+};
+
+inline BenchmarkResult evalSamples(std::vector<double> samplesMs) {
+  BenchmarkResult res;
+  res.runs = samplesMs.size();
+  if (samplesMs.empty()) {
+    return res;
+  }
+  std::sort(samplesMs.begin(), samplesMs.end());
+  const size_t n = samplesMs.size();
+  res.minMs = samplesMs.front();
+  res.medianMs = (n % 2 == 1)
+                     ? samplesMs[n / 2]
+                     : (samplesMs[n / 2 - 1] + samplesMs[n / 2]) / 2.0;
+  // Nearest rank.
+  const size_t p99Rank = static_cast<size_t>(std::ceil(0.99 * n));
+  res.p99Ms = samplesMs[std::max<size_t>(p99Rank, 1) - 1];
+  double sum = 0.0;
+  for (const double s : samplesMs) {
+    sum += s;
+  }
+  res.meanMs = sum / n;
+  if (n > 1) {
+    double sqSum = 0.0;
+    for (const double s : samplesMs) {
+      sqSum += (s - res.meanMs) * (s - res.meanMs);
+    }
+    res.stddevMs = std::sqrt(sqSum / (n - 1));
+  }
+  return res;
+}
+
+// Runs func until the 95 % confidence interval of the mean is within
+// +-relConfidence of the mean (or one of the limits is reached).
+template <typename Func>
+BenchmarkResult benchmark(Func func, int warmUps = 2, int minRuns = 10,
+                          size_t maxRuns = 10000, double maxSeconds = 5.0,
+                          double relConfidence = 0.01) {
+  SuppressOutput suppressOutput;
+  const auto benchStart = std::chrono::steady_clock::now();
+  auto secondsSince = [](const auto &start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         start)
+        .count();
+  };
+  for (int i = 0; i < warmUps && secondsSince(benchStart) < maxSeconds / 4.0;
+       ++i) {
+    func();
+  }
+  std::vector<double> samplesMs;
+  BenchmarkResult res;
+  do {
+    const auto start = std::chrono::steady_clock::now();
+    func();
+    samplesMs.push_back(secondsSince(start) * 1000.0);
+    if (samplesMs.size() >= 2) {
+      res = evalSamples(samplesMs);
+      const double ciHalfWidth = 1.96 * res.stddevMs / std::sqrt(res.runs);
+      if (res.runs >= minRuns && ciHalfWidth <= relConfidence * res.meanMs) {
+        break;
+      }
+    }
+  } while (samplesMs.size() < maxRuns && secondsSince(benchStart) < maxSeconds);
+  return evalSamples(samplesMs);
+}
+
+inline void printBenchmarkResult(const BenchmarkResult &res,
+                                 const std::string &name) {
+  std::cout << std::setprecision(6) << name << " benchmark: " << res.runs
+            << " runs, min " << res.minMs << " ms, median " << res.medianMs
+            << " ms, mean " << res.meanMs << " ms, p99 " << res.p99Ms
+            << " ms, stddev " << res.stddevMs << " ms\n";
+  std::cout << "{\"name\": \"" << name << "\", \"runs\": " << res.runs
+            << ", \"min_ms\": " << res.minMs
+            << ", \"median_ms\": " << res.medianMs
+            << ", \"mean_ms\": " << res.meanMs << ", \"p99_ms\": " << res.p99Ms
+            << ", \"stddev_ms\": " << res.stddevMs << "}\n";
+}
+
 template <typename Func>
 void measureTime(Func func, const std::string &name, int repetitions = 1) {
   std::cout << "Running " << name << "...\n";
@@ -93,6 +218,9 @@ void measureTime(Func func, const std::string &name, int repetitions = 1) {
                   static_cast<double>(repetitions))
               << " ms\n";
   }
+  if (benchmarkEnabled()) {
+    printBenchmarkResult(benchmark(func), name);
+  }
 }
 
 inline std::ostream &operator<<(std::ostream &os,
@@ -102,3 +230,198 @@ inline std::ostream &operator<<(std::ostream &os,
   }
   return os;
 }
+
+// Finaliser of splitmix64. Every input bit affects every output bit.
+inline uint64_t mixHash(uint64_t x) {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ull;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebull;
+  x ^= x >> 31;
+  return x;
+}
+
+// Open addressing hash map with linear probing in one flat array.
+// Each slot has a control byte which is either EMPTY or 7 bits of the hash of
+// its key. A lookup compares the control bytes of 16 slots at once and only
+// compares the keys of the slots whose byte matches.
+// The first 16 control bytes are mirrored behind the last one so that groups
+// at the end of the array can be loaded without wrapping.
+// Keys and values have to be default constructible. There is no erase.
+// Pointers to values stay valid until the size exceeds the reserved capacity.
+template <typename K, typename V, typename Hash = std::hash<K>>
+class FlatHashMap {
+public:
+  FlatHashMap() { allocate(GROUP_SIZE); }
+
+  size_t size() const { return numEntries; }
+  size_t capacity() const { return slots.size(); }
+
+  // Makes room for n entries without rehashing.
+  void reserve(size_t n) {
+    size_t capacity = GROUP_SIZE;
+    while (n > maxEntries(capacity)) {
+      capacity *= 2;
+    }
+    if (capacity > slots.size()) {
+      rehash(capacity);
+    }
+  }
+
+  // Removes all entries but keeps the memory.
+  void clear() {
+    for (size_t i = 0; i < slots.size(); ++i) {
+      if (ctrl[i] != EMPTY) {
+        slots[i] = Slot();
+      }
+    }
+    std::fill(ctrl.begin(), ctrl.end(), EMPTY);
+    numEntries = 0;
+  }
+
+  const V *find(const K &key) const {
+    const size_t index = findIndex(key, hashOf(key));
+    return ctrl[index] == EMPTY ? nullptr : &slots[index].second;
+  }
+
+  V *find(const K &key) {
+    return const_cast<V *>(std::as_const(*this).find(key));
+  }
+
+  size_t count(const K &key) const { return find(key) != nullptr; }
+
+  // Inserts V(args...) if the key is missing.
+  // Returns the value and whether it was inserted.
+  template <typename... Args>
+  std::pair<V *, bool> tryEmplace(const K &key, Args &&...args) {
+    const uint64_t hash = hashOf(key);
+    size_t index = findIndex(key, hash);
+    if (ctrl[index] != EMPTY) {
+      return {&slots[index].second, false};
+    }
+    if (numEntries + 1 > maxEntries(slots.size())) {
+      rehash(slots.size() * 2);
+      index = findIndex(key, hash);
+    }
+    setCtrl(index, shortHash(hash));
+    slots[index] = Slot(key, V(std::forward<Args>(args)...));
+    ++numEntries;
+    return {&slots[index].second, true};
+  }
+
+  V &operator[](const K &key) { return *tryEmplace(key).first; }
+
+  // Calls func(key, value) for all entries in no particular order.
+  template <typename Func> void forEach(Func func) const {
+    for (size_t i = 0; i < slots.size(); ++i) {
+      if (ctrl[i] != EMPTY) {
+        func(slots[i].first, slots[i].second);
+      }
+    }
+  }
+
+private:
+  using Slot = std::pair<K, V>;
+  static constexpr size_t GROUP_SIZE = 16;
+  static constexpr uint8_t EMPTY = 0x80;
+
+  // 7 / 8 load factor.
+  static size_t maxEntries(size_t capacity) { return capacity - capacity / 8; }
+
+  // Mixed because std::hash is the identity for integers.
+  static uint64_t hashOf(const K &key) { return mixHash(Hash{}(key)); }
+  static uint8_t shortHash(uint64_t hash) { return hash >> 57; }
+
+  // Bit i is set if byte i of the group equals value.
+  static uint32_t matchGroup(const uint8_t *group, uint8_t value) {
+#ifdef __SSE2__
+    const __m128i bytes =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(group));
+    return _mm_movemask_epi8(
+        _mm_cmpeq_epi8(bytes, _mm_set1_epi8(static_cast<char>(value))));
+#else
+    uint32_t mask = 0;
+    for (size_t i = 0; i < GROUP_SIZE; ++i) {
+      mask |= static_cast<uint32_t>(group[i] == value) << i;
+    }
+    return mask;
+#endif
+  }
+
+  // Index of the key or of the empty slot where it belongs.
+  size_t findIndex(const K &key, uint64_t hash) const {
+    const size_t mask = slots.size() - 1;
+    const uint8_t h = shortHash(hash);
+    for (size_t pos = hash & mask;; pos = (pos + GROUP_SIZE) & mask) {
+      for (uint32_t matches = matchGroup(&ctrl[pos], h); matches != 0;
+           matches &= matches - 1) {
+        const size_t index = (pos + __builtin_ctz(matches)) & mask;
+        if (slots[index].first == key) {
+          return index;
+        }
+      }
+      const uint32_t empties = matchGroup(&ctrl[pos], EMPTY);
+      if (empties != 0) {
+        return (pos + __builtin_ctz(empties)) & mask;
+      }
+    }
+  }
+
+  void setCtrl(size_t index, uint8_t value) {
+    ctrl[index] = value;
+    if (index < GROUP_SIZE) {
+      ctrl[slots.size() + index] = value;
+    }
+  }
+
+  void allocate(size_t capacity) {
+    ctrl.assign(capacity + GROUP_SIZE, EMPTY);
+    slots.clear();
+    slots.resize(capacity);
+    numEntries = 0;
+  }
+
+  void rehash(size_t capacity) {
+    std::vector<uint8_t> oldCtrl = std::move(ctrl);
+    std::vector<Slot> oldSlots = std::move(slots);
+    allocate(capacity);
+    for (size_t i = 0; i < oldSlots.size(); ++i) {
+      if (oldCtrl[i] != EMPTY) {
+        const uint64_t hash = hashOf(oldSlots[i].first);
+        const size_t index = findIndex(oldSlots[i].first, hash);
+        setCtrl(index, shortHash(hash));
+        slots[index] = std::move(oldSlots[i]);
+        ++numEntries;
+      }
+    }
+  }
+
+  std::vector<uint8_t> ctrl;
+  std::vector<Slot> slots;
+  size_t numEntries = 0;
+};
+
+// Insert and lookup throughput of FlatHashMap vs. std::unordered_map.
+template <typename K, typename Hash = std::hash<K>>
+void benchmarkHashMaps(const std::vector<K> &keys, const std::string &name) {
+  const auto run = [&keys](auto &map) {
+    for (const auto &key : keys) {
+      ++map[key];
+    }
+    size_t sum = 0;
+    for (const auto &key : keys) {
+      sum += map.count(key);
+    }
+    std::cout << sum << "\n";
+  };
+  printBenchmarkResult(benchmark([&run]() {
+                         std::unordered_map<K, int, Hash> map;
+                         run(map);
+                       }),
+                       name + " std::unordered_map");
+  printBenchmarkResult(benchmark([&run]() {
+                         FlatHashMap<K, int, Hash> map;
+                         run(map);
+                       }),
+                       name + " FlatHashMap");
+}
@@ -100,6 +100,14 @@ void solvePart2(const std::vector<std::vector<int>> &nums) {
   std::cout << safeCount << "\n";
 }
 
+#ifdef AOC_RUNNER
+AOC_REGISTER(2, 1, [](std::ifstream &ifs) {
+  solvePart1(parseCSVNumbers<int>(ifs, ' '));
+});
+AOC_REGISTER(2, 2, [](std::ifstream &ifs) {
+  solvePart2(parseCSVNumbers<int>(ifs, ' '));
+});
+#else
 int main() {
   std::ifstream ifs("input.txt");
   //std::ifstream ifs("input_test.txt");
@@ -108,4 +116,5 @@ int main() {
   measureTime([&nums]() { solvePart2(nums); }, "Part 2");
   std::cout << "Done.\n";
   return 0;
-}
\ No newline at end of file
+}
+#endif
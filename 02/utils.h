@@ -1,6 +1,11 @@
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <cstdlib>
 #include <iomanip>
 #include <iostream>
+#include <streambuf>
+#include <string>
 #include <vector>
 
 // This file is copied into each day.
@@ -57,6 +62,118 @@ inline bool operator==(const Coords_<T> &lhs, const Coords_<T> &rhs) {
 
 inline bool isDigit(char ch) { return 0x30 <= ch && ch < 0x3A; }
 
+// Benchmark mode.
+// Enable it by setting the environment variable AOC_BENCH, e.g.:
+// AOC_BENCH=1 ./solve
+// measureTime() then follows up its normal run with a proper benchmark of the
+// same function and prints the statistics in readable form plus as one JSON
+// line per measurement so that results can be collected across commits.
+inline bool benchmarkEnabled() { return std::getenv("AOC_BENCH") != nullptr; }
+
+// Swallows everything written to it.
+class NullBuffer : public std::streambuf {
+protected:
+  int overflow(int ch) override { return ch; }
+  std::streamsize xsputn(const char *, std::streamsize n) override { return n; }
+};
+
+// Keeps the output of the solutions out of the timed runs.
+class SuppressOutput {
+public:
+  SuppressOutput() : prevBuffer(std::cout.rdbuf(&nullBuffer)) {}
+  ~SuppressOutput() { std::cout.rdbuf(prevBuffer); }
+
+private:
+  NullBuffer nullBuffer;
+  std::streambuf *prevBuffer;
+};
+
+struct BenchmarkResult {
+  int runs = 0;
+  double minMs = 0.0;
+  double medianMs = 0.0;
+  double meanMs = 0.0;
+  double p99Ms = 0.0;
+  double stddevMs = 0.0;
+};
+
+inline BenchmarkResult evalSamples(std::vector<double> samplesMs) {
+  BenchmarkResult res;
+  res.runs = samplesMs.size();
+  if (samplesMs.empty()) {
+    return res;
+  }
+  std::sort(samplesMs.begin(), samplesMs.end());
+  const size_t n = samplesMs.size();
+  res.minMs = samplesMs.front();
+  res.medianMs = (n % 2 == 1)
+                     ? samplesMs[n / 2]
+                     : (samplesMs[n / 2 - 1] + samplesMs[n / 2]) / 2.0;
+  // Nearest rank.
+  const size_t p99Rank = static_cast<size_t>(std::ceil(0.99 * n));
+  res.p99Ms = samplesMs[std::max<size_t>(p99Rank, 1) - 1];
+  double sum = 0.0;
+  for (const double s : samplesMs) {
+    sum += s;
+  }
+  res.meanMs = sum / n;
+  if (n > 1) {
+    double sqSum = 0.0;
+    for (const double s : samplesMs) {
+      sqSum += (s - res.meanMs) * (s - res.meanMs);
+    }
+    res.stddevMs = std::sqrt(sqSum / (n - 1));
+  }
+  return res;
+}
+
+// Runs func until the 95 % confidence interval of the mean is within
+// +-relConfidence of the mean (or one of the limits is reached).
+template <typename Func>
+BenchmarkResult benchmark(Func func, int warmUps = 2, int minRuns = 10,
+                          size_t maxRuns = 10000, double maxSeconds = 5.0,
+                          double relConfidence = 0.01) {
+  SuppressOutput suppressOutput;
+  const auto benchStart = std::chrono::steady_clock::now();
+  auto secondsSince = [](const auto &start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         start)
+        .count();
+  };
+  for (int i = 0; i < warmUps && secondsSince(benchStart) < maxSeconds / 4.0;
+       ++i) {
+    func();
+  }
+  std::vector<double> samplesMs;
+  BenchmarkResult res;
+  do {
+    const auto start = std::chrono::steady_clock::now();
+    func();
+    samplesMs.push_back(secondsSince(start) * 1000.0);
+    if (samplesMs.size() >= 2) {
+      res = evalSamples(samplesMs);
+      const double ciHalfWidth = 1.96 * res.stddevMs / std::sqrt(res.runs);
+      if (res.runs >= minRuns && ciHalfWidth <= relConfidence * res.meanMs) {
+        break;
+      }
+    }
+  } while (samplesMs.size() < maxRuns && secondsSince(benchStart) < maxSeconds);
+  return evalSamples(samplesMs);
+}
+
+inline void printBenchmarkResult(const BenchmarkResult &res,
+                                 const std::string &name) {
+  std::cout << std::setprecision(6) << name << " benchmark: " << res.runs
+            << " runs, min " << res.minMs << " ms, median " << res.medianMs
+            << " ms, mean " << res.meanMs << " ms, p99 " << res.p99Ms
+            << " ms, stddev " << res.stddevMs << " ms\n";
+  std::cout << "{\"name\": \"" << name << "\", \"runs\": " << res.runs
+            << ", \"min_ms\": " << res.minMs
+            << ", \"median_ms\": " << res.medianMs
+            << ", \"mean_ms\": " << res.meanMs << ", \"p99_ms\": " << res.p99Ms
+            << ", \"stddev_ms\": " << res.stddevMs << "}\n";
+}
+
 template <typename Func>
 void measureTime(Func func, const std::string &name, int repetitions = 1) {
   std::cout << "Running " << name << "...\n";
@@ -93,6 +210,9 @@ void measureTime(Func func, const std::string &name, int repetitions = 1) {
                   static_cast<double>(repetitions))
               << " ms\n";
   }
+  if (benchmarkEnabled()) {
+    printBenchmarkResult(benchmark(func), name);
+  }
 }
 
 inline std::ostream &operator<<(std::ostream &os,
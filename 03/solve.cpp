@@ -1,110 +1,195 @@
 #include "utils.h"
+#include <algorithm>
 #include <fstream>
 #include <iostream>
-#include <regex>
-#include <sstream>
+#include <optional>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
-std::string readFile(std::ifstream &ifs) {
-  std::stringstream sstream;
-  sstream << ifs.rdbuf();
-  return std::string(sstream.str());
-}
+using num = long long;
 
-void solvePart1(const std::string &text) {
-  const char *haystack = text.c_str();
-  std::regex mulRegex("mul\\((\\d+),(\\d+)\\)");
-  int sum = 0;
-  for (std::cmatch cm; regex_search(haystack, cm, mulRegex);) {
-    const int a = std::stoi(cm[1].str());
-    const int b = std::stoi(cm[2].str());
-    sum += a * b;
-    haystack = &haystack[cm.position() + cm.length()];
+// Returns the next position at or after p that might start a token ('m' or
+// 'd') or end if there is none.
+const char *findTokenStart(const char *p, const char *end) {
+#ifdef __SSE2__
+  // Compare 16 bytes at once.
+  const __m128i m = _mm_set1_epi8('m');
+  const __m128i d = _mm_set1_epi8('d');
+  while (end - p >= 16) {
+    const __m128i chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    const int mask = _mm_movemask_epi8(
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, m), _mm_cmpeq_epi8(chunk, d)));
+    if (mask != 0) {
+      return p + __builtin_ctz(mask);
+    }
+    p += 16;
   }
-  std::cout << sum << "\n";
+#endif
+  while (p < end && *p != 'm' && *p != 'd') {
+    ++p;
+  }
+  return p;
 }
 
-struct Condition {
-  int pos;
-  bool enable;
-};
+bool matchLiteral(const char *p, const char *end, std::string_view literal) {
+  return static_cast<size_t>(end - p) >= literal.size() &&
+         std::string_view(p, literal.size()) == literal;
+}
 
-std::vector<Condition> findConditions(const std::string &text,
-                                      const std::string &regexString,
-                                      bool enable) {
-  const char *haystack = text.c_str();
-  std::vector<Condition> conditions;
-  std::regex condRegex(regexString);
-  int offset = 0;
-  for (std::cmatch cm; regex_search(haystack, cm, condRegex);) {
-    const int matchPos = offset + static_cast<int>(cm.position());
-    conditions.push_back({matchPos, enable});
-    offset = matchPos + cm.length();
-    haystack = &haystack[cm.position() + cm.length()];
+// Matches one to three digits followed by the terminator.
+bool matchNumber(const char *&p, const char *end, char terminator,
+                 num *value) {
+  const char *start = p;
+  *value = 0;
+  while (p < end && p - start < 3 && isDigit(*p)) {
+    *value = *value * 10 + (*p - '0');
+    ++p;
+  }
+  // A fourth digit is not the terminator, so it is rejected below.
+  if (p == start || p == end || *p != terminator) {
+    return false;
   }
-  return conditions;
+  ++p;
+  return true;
 }
 
-std::vector<Condition> mergeConditions(const std::vector<Condition> &dos,
-                                       const std::vector<Condition> &donts) {
-  std::vector<Condition> conditions;
-  conditions.reserve(dos.size() + donts.size());
-  std::size_t doPos = 0, dontPos = 0;
-  while (doPos < dos.size() && dontPos < donts.size()) {
-    if (dos[doPos].pos < donts[dontPos].pos) {
-      conditions.push_back(Condition{dos[doPos].pos, true});
-      ++doPos;
-    } else {
-      conditions.push_back(Condition{donts[dontPos].pos, false});
-      ++dontPos;
-    }
+// Matches "mul(a,b)" at p.
+bool matchMul(const char *p, const char *end, num *product) {
+  if (!matchLiteral(p, end, "mul(")) {
+    return false;
   }
-  while (doPos < dos.size()) {
-    conditions.push_back(Condition{dos[doPos].pos, true});
-    ++doPos;
+  p += 4;
+  num a, b;
+  if (!matchNumber(p, end, ',', &a) || !matchNumber(p, end, ')', &b)) {
+    return false;
   }
-  while (dontPos < donts.size()) {
-    conditions.push_back(Condition{donts[dontPos].pos, false});
-    ++dontPos;
+  *product = a * b;
+  return true;
+}
+
+// Result of scanning the tokens starting within one chunk of the text.
+// Tokens may reach into the next chunk. They are matched completely by the
+// chunk they start in, so nothing straddles the boundary.
+// Whether the first products are enabled depends on the previous chunks.
+// So the enabled sum is reported for both states on entering the chunk.
+struct ChunkResult {
+  num sumAll = 0; // Part 1
+  num sumEnteredEnabled = 0;
+  num sumEnteredDisabled = 0;
+  // State after the last do() / don't() in the chunk if there is one.
+  std::optional<bool> finalEnabled;
+};
+
+// Single linear scan for "mul(a,b)", "do()" and "don't()" starting in
+// text[begin, end) without any allocation.
+// None of the tokens contains an 'm' or 'd' after its first char. So after a
+// mismatch the scan can simply continue at the next candidate.
+ChunkResult scanChunk(std::string_view text, size_t begin, size_t end) {
+  ChunkResult res;
+  const char *textEnd = text.data() + text.size();
+  const char *chunkEnd = text.data() + end;
+  for (const char *p = findTokenStart(text.data() + begin, chunkEnd);
+       p < chunkEnd; p = findTokenStart(p + 1, chunkEnd)) {
+    num product;
+    if (*p == 'm') {
+      if (matchMul(p, textEnd, &product)) {
+        res.sumAll += product;
+        if (!res.finalEnabled) {
+          // Not known yet.
+          res.sumEnteredEnabled += product;
+        } else if (*res.finalEnabled) {
+          res.sumEnteredEnabled += product;
+          res.sumEnteredDisabled += product;
+        }
+      }
+    } else if (matchLiteral(p, textEnd, "do()")) {
+      res.finalEnabled = true;
+    } else if (matchLiteral(p, textEnd, "don't()")) {
+      res.finalEnabled = false;
+    }
   }
-  return conditions;
+  return res;
 }
 
-void solvePart2(const std::string &text) {
-  const auto dos = findConditions(text, "do\\(\\)", true);
-  const auto donts = findConditions(text, "don\\'t\\(\\)", false);
-  auto conditions = mergeConditions(dos, donts);
-  std::reverse(conditions.begin(), conditions.end());
-  const char *haystack = text.c_str();
-  std::regex mulRegex("mul\\((\\d+),(\\d+)\\)");
-  int sum = 0;
-  int lastMatchPos = 0;
+// Stitches the chunks together in order. Enabled at the start.
+ChunkResult reduceChunks(const std::vector<ChunkResult> &chunks) {
+  ChunkResult total;
   bool enabled = true;
-  int offset = 0;
-  for (std::cmatch cm; regex_search(haystack, cm, mulRegex);) {
-    const int matchPos = offset + static_cast<int>(cm.position());
-    while (!conditions.empty() && conditions.back().pos < matchPos) {
-      enabled = conditions.back().enable;
-      conditions.pop_back();
-    }
-    if (enabled) {
-      const int a = std::stoi(cm[1].str());
-      const int b = std::stoi(cm[2].str());
-      sum += a * b;
+  for (const auto &chunk : chunks) {
+    total.sumAll += chunk.sumAll;
+    total.sumEnteredEnabled +=
+        enabled ? chunk.sumEnteredEnabled : chunk.sumEnteredDisabled;
+    if (chunk.finalEnabled) {
+      enabled = *chunk.finalEnabled;
     }
-    offset = matchPos + cm.length();
-    haystack = &haystack[cm.position() + cm.length()];
   }
-  std::cout << sum << "\n";
+  total.finalEnabled = enabled;
+  return total;
 }
 
+// Smaller inputs are not worth starting threads.
+constexpr size_t MIN_CHUNK_SIZE = 1 << 20;
+
+// Splits the text into one chunk per thread.
+ChunkResult scanParallel(std::string_view text, size_t numChunks) {
+  numChunks = std::max<size_t>(1, numChunks);
+  const size_t chunkSize = (text.size() + numChunks - 1) / numChunks;
+  std::vector<ChunkResult> chunks(numChunks);
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < numChunks; ++i) {
+    threads.emplace_back([&chunks, text, chunkSize, i]() {
+      const size_t begin = std::min(text.size(), i * chunkSize);
+      const size_t end = std::min(text.size(), begin + chunkSize);
+      chunks[i] = scanChunk(text, begin, end);
+    });
+  }
+  chunks[0] = scanChunk(text, 0, std::min(text.size(), chunkSize));
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  return reduceChunks(chunks);
+}
+
+void solvePart1(std::string_view text) {
+  std::cout << scanChunk(text, 0, text.size()).sumAll << "\n";
+}
+
+void solvePart2(std::string_view text) {
+  std::cout << scanChunk(text, 0, text.size()).sumEnteredEnabled << "\n";
+}
+
+// Same result as solvePart2 but on all cores for large inputs.
+void solvePart2Parallel(std::string_view text) {
+  const size_t numChunks =
+      std::min<size_t>(std::thread::hardware_concurrency(),
+                       text.size() / MIN_CHUNK_SIZE + 1);
+  std::cout << scanParallel(text, numChunks).sumEnteredEnabled << "\n";
+}
+
+#ifdef AOC_RUNNER
+AOC_REGISTER(3, 1, [](const std::string &path) {
+  const MappedFile file(path);
+  solvePart1(file.text());
+});
+AOC_REGISTER(3, 2, [](const std::string &path) {
+  const MappedFile file(path);
+  solvePart2Parallel(file.text());
+});
+#else
 int main() {
-  std::ifstream ifs("input.txt");
-  // std::ifstream ifs("input_test.txt");
-  std::string text = readFile(ifs);
+  const MappedFile file("input.txt");
+  // const MappedFile file("input_test.txt");
+  const std::string_view text = file.text();
   measureTime([&text]() { solvePart1(text); }, "Part 1");
   measureTime([&text]() { solvePart2(text); }, "Part 2");
+  measureTime([&text]() { solvePart2Parallel(text); }, "Part 2 (parallel)");
   std::cout << "Done.\n";
   return 0;
-}
\ No newline at end of file
+}
+#endif
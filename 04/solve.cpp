@@ -1,84 +1,90 @@
 #include "utils.h"
+#include <array>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
+#include <random>
 #include <string>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Padding so that all cells of a word starting in the grid are in bounds.
+constexpr int PADDING = 3;
 
 struct Data {
-  std::vector<std::string> rows;
-  std::vector<std::string> cols;
-  std::vector<std::string> diags;
-  std::vector<std::string> diagsT;
+  Grid<char> grid;
 };
 
-std::vector<std::string> transpose(std::vector<std::string> &vec) {
-  std::vector<std::string> t;
-  for (size_t i = 0; i < vec.size(); ++i) {
-    const auto &si = vec[i];
-    const auto n = si.size();
-    if (t.size() < n) {
-      t.resize(n);
-    }
-    for (size_t j = 0; j < n; ++j) {
-      t[j].push_back(si[j]);
-    }
-  }
-  return t;
-}
-
-Data parseFile(std::ifstream &ifs) {
+Data parseFile(const MappedFile &file) {
   Data data;
-  std::string line;
-  int i = 0;
-  if (std::getline(ifs, line)) {
-    const int n = line.size();
-    assert(n % 2 == 0);
-    const int numDiags = 2 * n - 1;
-    data.diags.resize(numDiags);
-    data.diagsT.resize(numDiags);
-    do {
-      data.rows.push_back(line);
-      for (size_t j = 0; j < n; ++j) {
-        {
-          const int d = (n - 1) - i + j;
-          assert(d >= 0);
-          assert(d < numDiags);
-          data.diags[d].push_back(line[j]);
-        }
-        {
-          const int d = i + j;
-          assert(d >= 0);
-          assert(d < numDiags);
-          data.diagsT[d].push_back(line[j]);
-        }
-      }
-      ++i;
-    } while (std::getline(ifs, line));
-  }
-  data.cols = transpose(data.rows);
-  // std::cout << data.rows << "\n";
-  // std::cout << data.cols << "\n";
-  // std::cout << data.diags << "\n";
-  // std::cout << data.diagsT << "\n";
+  data.grid = Grid<char>::fromLines(file.lines(), PADDING, '.');
   return data;
 }
 
-int countXMAS(const std::string &str, const std::string &needle) {
-  int count = 0;
-  auto s = str.find(needle);
-  for (; s != std::string::npos; s = str.find(needle, s + needle.size())) {
-    ++count;
-  }
-  return count;
+// Offsets of the four directions. The other four are covered by searching
+// for the reversed word.
+std::array<std::ptrdiff_t, 4> makeDirs(const Grid<char> &grid) {
+  return {grid.offset(Coords_<int>(0, 1)), grid.offset(Coords_<int>(1, 0)),
+          grid.offset(Coords_<int>(1, 1)), grid.offset(Coords_<int>(1, -1))};
+}
+
+int countXMASAt(const char *c, std::ptrdiff_t dir) {
+  const char c0 = c[0], c1 = c[dir], c2 = c[2 * dir], c3 = c[3 * dir];
+  return (c0 == 'X' && c1 == 'M' && c2 == 'A' && c3 == 'S') +
+         (c0 == 'S' && c1 == 'A' && c2 == 'M' && c3 == 'X');
+}
+
+#ifdef __SSE2__
+// Counts the words starting at the 16 cells from c on.
+int countXMAS16(const char *c, std::ptrdiff_t dir) {
+  const auto load = [](const char *p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+  };
+  const __m128i x = _mm_set1_epi8('X');
+  const __m128i m = _mm_set1_epi8('M');
+  const __m128i a = _mm_set1_epi8('A');
+  const __m128i s = _mm_set1_epi8('S');
+  const __m128i c0 = load(c);
+  const __m128i c1 = load(c + dir);
+  const __m128i c2 = load(c + 2 * dir);
+  const __m128i c3 = load(c + 3 * dir);
+  const __m128i forward = _mm_and_si128(
+      _mm_and_si128(_mm_cmpeq_epi8(c0, x), _mm_cmpeq_epi8(c1, m)),
+      _mm_and_si128(_mm_cmpeq_epi8(c2, a), _mm_cmpeq_epi8(c3, s)));
+  const __m128i backward = _mm_and_si128(
+      _mm_and_si128(_mm_cmpeq_epi8(c0, s), _mm_cmpeq_epi8(c1, a)),
+      _mm_and_si128(_mm_cmpeq_epi8(c2, m), _mm_cmpeq_epi8(c3, x)));
+  return __builtin_popcount(_mm_movemask_epi8(forward)) +
+         __builtin_popcount(_mm_movemask_epi8(backward));
 }
+#endif
 
+// Single pass over the flat grid in all eight directions.
+// The padding cells between the rows never match, so the rows are scanned as
+// one contiguous range.
 void solvePart1(const Data &data) {
+  const auto &grid = data.grid;
+  const auto dirs = makeDirs(grid);
   int count = 0;
-  for (const auto channel :
-       {&data.rows, &data.cols, &data.diags, &data.diagsT}) {
-    for (const auto &str : *channel) {
-      count += countXMAS(str, "XMAS");
-      count += countXMAS(str, "SAMX");
+  if (grid.rows > 0 && grid.cols > 0) {
+    const char *c = &grid[grid.index(0, 0)];
+    const char *end = &grid[grid.index(grid.rows - 1, grid.cols - 1)] + 1;
+#ifdef __SSE2__
+    for (; c + 16 <= end; c += 16) {
+      for (const auto dir : dirs) {
+        count += countXMAS16(c, dir);
+      }
+    }
+#endif
+    for (; c < end; ++c) {
+      for (const auto dir : dirs) {
+        count += countXMASAt(c, dir);
+      }
     }
   }
   std::cout << count << "\n";
@@ -88,29 +94,140 @@ bool isMAS(char c1, char c2) {
   return (c1 == 'M' && c2 == 'S') || (c1 == 'S' && c2 == 'M');
 }
 
-void solvePart2(const Data &data) {
-  const auto &rows = data.rows;
+// Reference implementation looking at the corners of each 'A'.
+int countXMASScalar(const Grid<char> &grid) {
+  // Offsets from the 'A' to the corners.
+  const auto upLeft = grid.offset(Coords_<int>(-1, -1));
+  const auto upRight = grid.offset(Coords_<int>(-1, 1));
   int count = 0;
-  const int n = rows.size();
-  for (int i = 1; i + 1 < n; ++i) {
-    const auto &row = rows[i];
-    for (int j = 1; j + 1 < n; ++j) {
-      if (row[j] == 'A' && isMAS(rows[i - 1][j - 1], rows[i + 1][j + 1]) &&
-          isMAS(rows[i - 1][j + 1], rows[i + 1][j - 1])) {
+  for (int i = 1; i + 1 < grid.rows; ++i) {
+    for (int j = 1; j + 1 < grid.cols; ++j) {
+      const size_t a = grid.index(i, j);
+      if (grid[a] == 'A' && isMAS(grid[a + upLeft], grid[a - upLeft]) &&
+          isMAS(grid[a + upRight], grid[a - upRight])) {
         ++count;
       }
     }
   }
-  std::cout << count << "\n";
+  return count;
 }
 
+// One bit per cell for each letter of "MAS".
+// Each row has a zero word before and after it so that the bits of the
+// neighbouring words can be shifted in without bounds checks.
+struct BitPlanes {
+  explicit BitPlanes(const Grid<char> &grid)
+      : rows(grid.rows), words((grid.cols + 63) / 64), stride(words + 2),
+        m(rows * stride), a(rows * stride), s(rows * stride) {
+    for (int i = 0; i < rows; ++i) {
+      const char *row = &grid(i, 0);
+      int j = 0;
+#ifdef __SSE2__
+      const __m128i mChar = _mm_set1_epi8('M');
+      const __m128i aChar = _mm_set1_epi8('A');
+      const __m128i sChar = _mm_set1_epi8('S');
+      for (; j + 16 <= grid.cols; j += 16) {
+        const __m128i c =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + j));
+        const size_t w = index(i, j / 64);
+        const int shift = j % 64;
+        m[w] |= uint64_t(_mm_movemask_epi8(_mm_cmpeq_epi8(c, mChar))) << shift;
+        a[w] |= uint64_t(_mm_movemask_epi8(_mm_cmpeq_epi8(c, aChar))) << shift;
+        s[w] |= uint64_t(_mm_movemask_epi8(_mm_cmpeq_epi8(c, sChar))) << shift;
+      }
+#endif
+      for (; j < grid.cols; ++j) {
+        const size_t w = index(i, j / 64);
+        const int shift = j % 64;
+        m[w] |= uint64_t(row[j] == 'M') << shift;
+        a[w] |= uint64_t(row[j] == 'A') << shift;
+        s[w] |= uint64_t(row[j] == 'S') << shift;
+      }
+    }
+  }
+
+  size_t index(int row, int word) const { return row * stride + word + 1; }
+
+  int rows;
+  int words;
+  int stride;
+  std::vector<uint64_t> m, a, s;
+};
+
+// Bits of the cells to the left resp. right moved onto the cells.
+uint64_t fromLeft(const std::vector<uint64_t> &plane, size_t w) {
+  return (plane[w] << 1) | (plane[w - 1] >> 63);
+}
+
+uint64_t fromRight(const std::vector<uint64_t> &plane, size_t w) {
+  return (plane[w] >> 1) | (plane[w + 1] << 63);
+}
+
+// Tests 64 cells at once.
+int countXMASBitboard(const Grid<char> &grid) {
+  const BitPlanes planes(grid);
+  int count = 0;
+  for (int i = 1; i + 1 < planes.rows; ++i) {
+    for (int w = 0; w < planes.words; ++w) {
+      const uint64_t a = planes.a[planes.index(i, w)];
+      if (a == 0) {
+        continue;
+      }
+      const size_t up = planes.index(i - 1, w);
+      const size_t down = planes.index(i + 1, w);
+      const uint64_t diag =
+          (fromLeft(planes.m, up) & fromRight(planes.s, down)) |
+          (fromLeft(planes.s, up) & fromRight(planes.m, down));
+      const uint64_t antiDiag =
+          (fromRight(planes.m, up) & fromLeft(planes.s, down)) |
+          (fromRight(planes.s, up) & fromLeft(planes.m, down));
+      count += __builtin_popcountll(a & diag & antiDiag);
+    }
+  }
+  return count;
+}
+
+void solvePart2(const Data &data) {
+  std::cout << countXMASBitboard(data.grid) << "\n";
+}
+
+// Compares both part 2 implementations on random grids of growing size.
+void benchmarkPart2() {
+  std::mt19937 rng(4);
+  for (const int n : {140, 1000, 4000, 10000}) {
+    Grid<char> grid(n, n, '.', PADDING, '.');
+    for (int i = 0; i < n; ++i) {
+      for (int j = 0; j < n; ++j) {
+        grid(i, j) = "XMAS"[rng() % 4];
+      }
+    }
+    assert(countXMASScalar(grid) == countXMASBitboard(grid));
+    const std::string size = std::to_string(n) + "x" + std::to_string(n);
+    printBenchmarkResult(benchmark([&grid]() { countXMASScalar(grid); }),
+                         "Part 2 scalar " + size);
+    printBenchmarkResult(benchmark([&grid]() { countXMASBitboard(grid); }),
+                         "Part 2 bitboard " + size);
+  }
+}
+
+#ifdef AOC_RUNNER
+AOC_REGISTER(4, 1, [](const std::string &path) {
+  solvePart1(parseFile(MappedFile(path)));
+});
+AOC_REGISTER(4, 2, [](const std::string &path) {
+  solvePart2(parseFile(MappedFile(path)));
+});
+#else
 int main() {
-  std::ifstream ifs("input.txt");
-  // std::ifstream ifs("input_test.txt");
-  //  std::ifstream ifs("input_test1.txt");
-  const auto data = parseFile(ifs);
+  const auto data = parseFile(MappedFile("input.txt"));
+  // const auto data = parseFile(MappedFile("input_test.txt"));
+  // const auto data = parseFile(MappedFile("input_test1.txt"));
   measureTime([&data]() { solvePart1(data); }, "Part 1");
   measureTime([&data]() { solvePart2(data); }, "Part 2");
+  if (benchmarkEnabled()) {
+    benchmarkPart2();
+  }
   std::cout << "Done.\n";
   return 0;
-}
\ No newline at end of file
+}
+#endif
@@ -1,79 +1,170 @@
 #include "utils.h"
+#include <algorithm>
+#include <bitset>
+#include <cassert>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
 #include <string>
-#include <map>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+// Answers whether a rule requires a page to be printed before another one.
+// Two digit pages are looked up in a bit matrix, larger ones in a hash set.
+class RuleIndex {
+public:
+  void add(int before, int after) {
+    if (isSmall(before) && isSmall(after)) {
+      small.set(before * SMALL_PAGES + after);
+    } else {
+      large.insert(key(before, after));
+    }
+  }
+
+  bool isBefore(int lhs, int rhs) const {
+    if (isSmall(lhs) && isSmall(rhs)) {
+      return small.test(lhs * SMALL_PAGES + rhs);
+    }
+    return large.count(key(lhs, rhs)) != 0;
+  }
+
+private:
+  static constexpr int SMALL_PAGES = 100;
+
+  static bool isSmall(int page) { return 0 <= page && page < SMALL_PAGES; }
+  static uint64_t key(int before, int after) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(before)) << 32) |
+           static_cast<uint32_t>(after);
+  }
+
+  std::bitset<SMALL_PAGES * SMALL_PAGES> small;
+  std::unordered_set<uint64_t> large;
+};
 
 struct Data {
-  std::vector<std::pair<int, int>> rules;
+  RuleIndex rules;
   std::vector<std::vector<int>> updates;
 };
 
 Data parseFile(std::ifstream &ifs) {
   Data data;
   std::string line;
-  int row = 0;
   while (std::getline(ifs, line) && line != "") {
-    data.rules.emplace_back(std::stoi(line.substr(0, 2)),
-                            std::stoi(line.substr(3, 2)));
+    const auto sep = line.find('|');
+    data.rules.add(std::stoi(line.substr(0, sep)),
+                   std::stoi(line.substr(sep + 1)));
   }
   data.updates = parseCSVNumbers<int>(ifs, ',');
   return data;
 }
 
-bool findInMap(const std::map<int, size_t>& numPositions, int num, size_t* outPos) {
-  const auto it = numPositions.find(num);
-  bool found = (it != numPositions.end());
-  if (found) {
-    *outPos = it->second;
-  }
-  return found;
-}
-
-void solvePart1And2(Data &data) {
+// The rules define a total order on the pages of each update.
+// So sorting with them as comparator yields the corrected update in
+// O(k log k) independent of the number of rules.
+void solvePart1And2(const Data &data) {
+  const auto isBefore = [&rules = data.rules](int lhs, int rhs) {
+    return rules.isBefore(lhs, rhs);
+  };
   int sumCorrect = 0;
   int sumIncorrect = 0;
-  for (auto& u : data.updates) {
-    std::map<int, size_t> numPositions;
-    for (size_t i = 0; i < u.size(); ++i) {
-      numPositions[u[i]] = i;
-    }
-    bool initiallyCorrect = true;
-    bool correct = false; // For correction of incorrect.
-    // Not the fastest solution but it is short.
-    while (!correct) {
-      correct = true;
-      for (const auto& r : data.rules) {
-        const int num1 = r.first;
-        const int num2 = r.second;
-        size_t pos1, pos2;
-        if (findInMap(numPositions, num1, &pos1) && findInMap(numPositions, num2, &pos2)) {
-          // Both nums of rule are in update.
-          if (pos1 > pos2) {
-            initiallyCorrect = false;
-            correct = false;
-            std::swap(u[pos1], u[pos2]);
-            std::swap(numPositions[num1], numPositions[num2]);
-          }
-        }
-      }
-    }
-    if (initiallyCorrect) {
+  for (const auto &u : data.updates) {
+    if (std::is_sorted(u.begin(), u.end(), isBefore)) {
       sumCorrect += u[u.size() / 2];
-    }
-    else {
-      sumIncorrect += u[u.size() / 2];
+    } else {
+      auto corrected = u;
+      std::sort(corrected.begin(), corrected.end(), isBefore);
+      sumIncorrect += corrected[corrected.size() / 2];
     }
   }
   std::cout << "Part 1: " << sumCorrect << "\n";
   std::cout << "Part 2: " << sumIncorrect << "\n";
 }
 
+// Middle page of the corrected update without correcting it.
+// In the corrected order it is the page with k / 2 predecessors.
+int middlePage(const RuleIndex &rules, const std::vector<int> &u) {
+  const size_t middle = u.size() / 2;
+  for (const int page : u) {
+    size_t predecessors = 0;
+    for (const int other : u) {
+      predecessors += rules.isBefore(other, page);
+    }
+    if (predecessors == middle) {
+      return page;
+    }
+  }
+  assert(false);
+  return 0;
+}
+
+struct Sums {
+  int correct = 0;
+  int incorrect = 0;
+};
+
+Sums sumMiddlePages(const Data &data, size_t begin, size_t end) {
+  const auto isBefore = [&rules = data.rules](int lhs, int rhs) {
+    return rules.isBefore(lhs, rhs);
+  };
+  Sums sums;
+  for (size_t i = begin; i < end; ++i) {
+    const auto &u = data.updates[i];
+    if (std::is_sorted(u.begin(), u.end(), isBefore)) {
+      sums.correct += u[u.size() / 2];
+    } else {
+      sums.incorrect += middlePage(data.rules, u);
+    }
+  }
+  return sums;
+}
+
+// Smaller inputs are not worth starting threads.
+constexpr size_t MIN_UPDATES_PER_THREAD = 10000;
+
+// Same result as solvePart1And2 but only selects the middle pages and splits
+// the updates across threads.
+void solvePart1And2MiddleOnly(const Data &data) {
+  const size_t numUpdates = data.updates.size();
+  const size_t numThreads = std::max<size_t>(
+      1, std::min<size_t>(std::thread::hardware_concurrency(),
+                          numUpdates / MIN_UPDATES_PER_THREAD));
+  const size_t perThread = (numUpdates + numThreads - 1) / numThreads;
+  std::vector<Sums> sums(numThreads);
+  std::vector<std::thread> threads;
+  for (size_t t = 1; t < numThreads; ++t) {
+    threads.emplace_back([&data, &sums, perThread, numUpdates, t]() {
+      const size_t begin = std::min(numUpdates, t * perThread);
+      sums[t] =
+          sumMiddlePages(data, begin, std::min(numUpdates, begin + perThread));
+    });
+  }
+  sums[0] = sumMiddlePages(data, 0, std::min(numUpdates, perThread));
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  Sums total;
+  for (const auto &s : sums) {
+    total.correct += s.correct;
+    total.incorrect += s.incorrect;
+  }
+  std::cout << "Part 1: " << total.correct << "\n";
+  std::cout << "Part 2: " << total.incorrect << "\n";
+}
+
+#ifdef AOC_RUNNER
+AOC_REGISTER(5, aoc::PART_BOTH, [](std::ifstream &ifs) {
+  solvePart1And2MiddleOnly(parseFile(ifs));
+});
+#else
 int main() {
   std::ifstream ifs("input.txt");
   //std::ifstream ifs("input_test.txt");
-  auto data = parseFile(ifs);
+  const auto data = parseFile(ifs);
   measureTime([&data]() { solvePart1And2(data); }, "Part 1 + 2");
+  measureTime([&data]() { solvePart1And2MiddleOnly(data); },
+              "Part 1 + 2 (middle only)");
   std::cout << "Done.\n";
   return 0;
-}
\ No newline at end of file
+}
+#endif
@@ -1,10 +1,15 @@
 #include "utils.h"
+#include <algorithm>
 #include <array>
 #include <cassert>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <set>
 #include <string>
+#include <thread>
+#include <vector>
 
 using Coords = Coords_<int>;
 
@@ -19,145 +24,213 @@ inline bool operator<(const Coords &lhs, const Coords &rhs) {
   }
 }
 
-std::vector<std::string> parseFile(std::ifstream &ifs) {
+// Border around the map so that leaving it needs no bounds check.
+constexpr char OUTSIDE = ' ';
+
+Grid<char> parseFile(std::ifstream &ifs) {
   std::vector<std::string> lines;
   std::string line;
-  int row = 0;
   while (std::getline(ifs, line)) {
     lines.push_back(line);
   }
-  return lines;
+  return Grid<char>::fromLines(lines, 1, OUTSIDE);
 }
 
-Coords searchStart(const std::vector<std::string> &lines) {
-  for (int row = 0; row < lines.size(); ++row) {
-    const auto &line = lines[row];
-    for (int col = 0; col < line.size(); ++col) {
-      if (line[col] == '^') {
-        return Coords(row, col);
-      }
-    }
-  }
-  assert(false);
-  return Coords(0, 0);
+size_t searchStart(const Grid<char> &grid) {
+  const auto it = std::find(grid.cells.begin(), grid.cells.end(), '^');
+  assert(it != grid.cells.end());
+  return it - grid.cells.begin();
 }
 
-bool withinBounds(const Coords &pos, const Coords &bounds) {
-  return pos.row >= 0 && pos.row < bounds.row && pos.col >= 0 &&
-         pos.col < bounds.col;
+// Linear index offsets for up, right, down, left.
+std::array<std::ptrdiff_t, 4> makeDirs(const Grid<char> &grid) {
+  return {grid.offset(Coords(-1, 0)), grid.offset(Coords(0, 1)),
+          grid.offset(Coords(1, 0)), grid.offset(Coords(0, -1))};
 }
 
-std::set<Coords> solvePart1(const std::vector<std::string> &lines_) {
-  assert(lines_.size() > 0);
-  assert(lines_[0].size() > 0);
+// Returns the positions visited by the guard except the start position.
+std::set<Coords> walkGuard(const Grid<char> &grid_, int *outCount) {
+  assert(grid_.rows > 0);
+  assert(grid_.cols > 0);
   std::set<Coords> positions;
-  std::vector<std::string> lines = lines_; // Copy
-  const std::array<Coords, 4> dirs = {Coords(-1, 0), Coords(0, 1), Coords(1, 0),
-                                      Coords(0, -1)};
-  const Coords bounds(lines.size(), lines[0].size());
-  const Coords posStart = searchStart(lines);
-  Coords pos = posStart;
+  Grid<char> grid = grid_; // Copy
+  const auto dirs = makeDirs(grid);
+  const size_t posStart = searchStart(grid);
+  size_t pos = posStart;
   int dirIndex = 0; // Up
-  lines[pos.row][pos.col] = 'X';
+  grid[pos] = 'X';
   int count = 1;
   while (true) {
-    const Coords nextPos = pos + dirs[dirIndex];
-    if (!withinBounds(nextPos, bounds)) {
+    const size_t nextPos = pos + dirs[dirIndex];
+    char &ch = grid[nextPos];
+    if (ch == OUTSIDE) {
       break;
+    } else if (ch == '#') {
+      dirIndex = (dirIndex + 1) % dirs.size();
     } else {
-      char &ch = lines[nextPos.row][nextPos.col];
-      if (ch == '#') {
-        dirIndex = (dirIndex + 1) % dirs.size();
-      } else {
-        // Free.
-        if (ch != 'X') {
-          // Not seen yet.
-          ch = 'X';
-          ++count;
-        }
-        pos = nextPos;
-        if (!(pos == posStart)) {
-          positions.insert(pos);
-        }
+      // Free.
+      if (ch != 'X') {
+        // Not seen yet.
+        ch = 'X';
+        ++count;
+      }
+      pos = nextPos;
+      if (pos != posStart) {
+        positions.insert(grid.coords(pos));
       }
     }
   }
-  // std::cout << lines << "\n";
+  *outCount = count;
+  return positions;
+}
+
+std::set<Coords> solvePart1(const Grid<char> &grid) {
+  int count;
+  auto positions = walkGuard(grid, &count);
   std::cout << count << "\n";
   return positions;
 }
 
 // PART 2
 
-constexpr char DIR_CHAR_0 = 'A';
+constexpr uint32_t EXIT = std::numeric_limits<uint32_t>::max();
 
-void addDir(char &ch, int dirIndex) {
-  char encoding = (1 << dirIndex);
-  if (ch == '.') {
-    ch = DIR_CHAR_0 + encoding;
-  } else {
-    ch = DIR_CHAR_0 + ((ch - DIR_CHAR_0) | encoding);
+// Up, right, down, left like makeDirs().
+const std::array<Coords, 4> DIR_COORDS = {Coords(-1, 0), Coords(0, 1),
+                                          Coords(1, 0), Coords(0, -1)};
+
+// For each cell and direction: The cell where the guard stops in front of the
+// next obstacle or EXIT if the guard leaves the map.
+// With it only the turning points need to be visited instead of every cell.
+struct JumpTable {
+  JumpTable(const Grid<char> &grid) : stops(grid.cells.size() * 4, EXIT) {
+    const auto dirs = makeDirs(grid);
+    const size_t n = grid.cells.size();
+    for (int dirIndex = 0; dirIndex < 4; ++dirIndex) {
+      // The neighbour in direction dirIndex needs to be done first.
+      const bool ascending = dirs[dirIndex] < 0;
+      for (size_t i = 0; i < n; ++i) {
+        const size_t pos = ascending ? i : n - 1 - i;
+        if (grid[pos] == OUTSIDE || grid[pos] == '#') {
+          continue;
+        }
+        const size_t nextPos = pos + dirs[dirIndex];
+        const char ch = grid[nextPos];
+        if (ch == '#') {
+          stops[pos * 4 + dirIndex] = pos;
+        } else if (ch != OUTSIDE) {
+          stops[pos * 4 + dirIndex] = stops[nextPos * 4 + dirIndex];
+        }
+      }
+    }
   }
+
+  uint32_t operator()(size_t pos, int dirIndex) const {
+    return stops[pos * 4 + dirIndex];
+  }
+
+  std::vector<uint32_t> stops;
+};
+
+// Steps from pos in direction dir to reach target or -1 if target is not
+// ahead.
+int stepsTo(const Coords &pos, const Coords &dir, const Coords &target) {
+  const Coords diff = target - pos;
+  if (dir.row != 0) {
+    return (diff.col == 0 && diff.row * dir.row > 0) ? diff.row * dir.row : -1;
+  }
+  return (diff.row == 0 && diff.col * dir.col > 0) ? diff.col * dir.col : -1;
 }
 
-bool hasDir(char ch, int dirIndex) {
-  if (ch == '.') {
-    return false;
+// The jump table does not know the additional obstruction.
+// Instead of changing the table, each jump checks whether the obstruction cuts
+// it short. So the table can be shared by all candidates and threads.
+// A loop is found when the guard stops at the same cell in the same direction
+// twice. visited holds the epoch of the last candidate that visited a
+// cell / direction which saves resetting it.
+bool hasLoop(const Grid<char> &grid, const JumpTable &jumps, size_t posStart,
+             const Coords &obsPos, std::vector<uint32_t> &visited,
+             uint32_t epoch) {
+  Coords pos = grid.coords(posStart);
+  int dirIndex = 0; // Up
+  while (true) {
+    const Coords &dir = DIR_COORDS[dirIndex];
+    const uint32_t stop = jumps(grid.index(pos), dirIndex);
+    bool blocked = (stop != EXIT);
+    Coords nextPos = blocked ? grid.coords(stop) : pos;
+    const int obsSteps = stepsTo(pos, dir, obsPos);
+    if (obsSteps > 0 &&
+        (!blocked || obsSteps <= (nextPos - pos).manhattanDistance())) {
+      nextPos = obsPos - dir;
+      blocked = true;
+    }
+    if (!blocked) {
+      return false;
+    }
+    pos = nextPos;
+    uint32_t &v = visited[grid.index(pos) * 4 + dirIndex];
+    if (v == epoch) {
+      return true;
+    }
+    v = epoch;
+    dirIndex = (dirIndex + 1) % 4;
   }
-  char encoding = (1 << dirIndex);
-  return ((ch - DIR_CHAR_0) & encoding) != 0;
 }
 
-void solvePart2(const std::vector<std::string> &lines_,
-                const std::set<Coords> &obsPositions) {
-  assert(lines_.size() > 0);
-  assert(lines_[0].size() > 0);
-  int count = 0;
-  for (const auto &obsPos : obsPositions) {
-    std::vector<std::string> lines = lines_; // Copy
-    lines[obsPos.row][obsPos.col] = '#';
-    const std::array<Coords, 4> dirs = {Coords(-1, 0), Coords(0, 1),
-                                        Coords(1, 0), Coords(0, -1)};
-    const Coords bounds(lines.size(), lines[0].size());
-    Coords pos = searchStart(lines);
-    int dirIndex = 0;              // Up
-    lines[pos.row][pos.col] = '.'; // Clear '^'.
-    addDir(lines[pos.row][pos.col], dirIndex);
-    while (true) {
-      const Coords nextPos = pos + dirs[dirIndex];
-      if (!withinBounds(nextPos, bounds)) {
-        break;
-      } else {
-        char &ch = lines[nextPos.row][nextPos.col];
-        if (ch == '#') {
-          dirIndex = (dirIndex + 1) % dirs.size();
-        } else {
-          // Free.
-          if (hasDir(ch, dirIndex)) {
-            // Loop!
-            ++count;
-            break;
-          } else {
-            // No loop
-            addDir(ch, dirIndex);
-          }
-          pos = nextPos;
-        }
+// Candidates are checked independently on one thread per core.
+void solvePart2(const Grid<char> &grid, const std::set<Coords> &obsPositions,
+                unsigned numThreads = std::thread::hardware_concurrency()) {
+  assert(grid.rows > 0);
+  assert(grid.cols > 0);
+  numThreads = std::max(1u, numThreads);
+  const JumpTable jumps(grid);
+  const size_t posStart = searchStart(grid);
+  const std::vector<Coords> candidates(obsPositions.begin(),
+                                       obsPositions.end());
+  std::vector<int> counts(numThreads, 0);
+  auto work = [&](unsigned t) {
+    std::vector<uint32_t> visited(grid.cells.size() * 4, 0);
+    uint32_t epoch = 0;
+    // Interleaved so that all threads get candidates from the whole map.
+    for (size_t i = t; i < candidates.size(); i += numThreads) {
+      if (hasLoop(grid, jumps, posStart, candidates[i], visited, ++epoch)) {
+        ++counts[t];
       }
     }
+  };
+  std::vector<std::thread> threads;
+  for (unsigned t = 1; t < numThreads; ++t) {
+    threads.emplace_back(work, t);
+  }
+  work(0);
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  int count = 0;
+  for (const int c : counts) {
+    count += c;
   }
   std::cout << count << "\n";
 }
 
+#ifdef AOC_RUNNER
+AOC_REGISTER(6, 1, [](std::ifstream &ifs) { solvePart1(parseFile(ifs)); });
+AOC_REGISTER_HEAVY(6, 2, [](std::ifstream &ifs) {
+  const auto grid = parseFile(ifs);
+  int count;
+  solvePart2(grid, walkGuard(grid, &count));
+});
+#else
 int main() {
   std::ifstream ifs("input.txt");
   // std::ifstream ifs("input_test.txt");
-  const auto lines = parseFile(ifs);
+  const auto grid = parseFile(ifs);
   std::set<Coords> positions;
-  measureTime([&lines, &positions]() { positions = solvePart1(lines); },
+  measureTime([&grid, &positions]() { positions = solvePart1(grid); },
               "Part 1");
-  measureTime([&lines, &positions]() { solvePart2(lines, positions); },
+  measureTime([&grid, &positions]() { solvePart2(grid, positions); },
               "Part 2");
   std::cout << "Done.\n";
   return 0;
-}
\ No newline at end of file
+}
+#endif
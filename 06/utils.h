@@ -1,8 +1,15 @@
+#include <algorithm>
+#include <array>
 #include <charconv>
 #include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <streambuf>
+#include <string>
 #include <string_view>
 #include <vector>
 
@@ -66,6 +73,118 @@ inline std::ostream& operator<<(std::ostream& os, const Coords_<T> &rhs) {
 
 inline bool isDigit(char ch) { return 0x30 <= ch && ch < 0x3A; }
 
+// Benchmark mode.
+// Enable it by setting the environment variable AOC_BENCH, e.g.:
+// AOC_BENCH=1 ./solve
+// measureTime() then follows up its normal run with a proper benchmark of the
+// same function and prints the statistics in readable form plus as one JSON
+// line per measurement so that results can be collected across commits.
+inline bool benchmarkEnabled() { return std::getenv("AOC_BENCH") != nullptr; }
+
+// Swallows everything written to it.
+class NullBuffer : public std::streambuf {
+protected:
+  int overflow(int ch) override { return ch; }
+  std::streamsize xsputn(const char *, std::streamsize n) override { return n; }
+};
+
+// Keeps the output of the solutions out of the timed runs.
+class SuppressOutput {
+public:
+  SuppressOutput() : prevBuffer(std::cout.rdbuf(&nullBuffer)) {}
+  ~SuppressOutput() { std::cout.rdbuf(prevBuffer); }
+
+private:
+  NullBuffer nullBuffer;
+  std::streambuf *prevBuffer;
+};
+
+struct BenchmarkResult {
+  int runs = 0;
+  double minMs = 0.0;
+  double medianMs = 0.0;
+  double meanMs = 0.0;
+  double p99Ms = 0.0;
+  double stddevMs = 0.0;
+};
+
+inline BenchmarkResult evalSamples(std::vector<double> samplesMs) {
+  BenchmarkResult res;
+  res.runs = samplesMs.size();
+  if (samplesMs.empty()) {
+    return res;
+  }
+  std::sort(samplesMs.begin(), samplesMs.end());
+  const size_t n = samplesMs.size();
+  res.minMs = samplesMs.front();
+  res.medianMs = (n % 2 == 1)
+                     ? samplesMs[n / 2]
+                     : (samplesMs[n / 2 - 1] + samplesMs[n / 2]) / 2.0;
+  // Nearest rank.
+  const size_t p99Rank = static_cast<size_t>(std::ceil(0.99 * n));
+  res.p99Ms = samplesMs[std::max<size_t>(p99Rank, 1) - 1];
+  double sum = 0.0;
+  for (const double s : samplesMs) {
+    sum += s;
+  }
+  res.meanMs = sum / n;
+  if (n > 1) {
+    double sqSum = 0.0;
+    for (const double s : samplesMs) {
+      sqSum += (s - res.meanMs) * (s - res.meanMs);
+    }
+    res.stddevMs = std::sqrt(sqSum / (n - 1));
+  }
+  return res;
+}
+
+// Runs func until the 95 % confidence interval of the mean is within
+// +-relConfidence of the mean (or one of the limits is reached).
+template <typename Func>
+BenchmarkResult benchmark(Func func, int warmUps = 2, int minRuns = 10,
+                          size_t maxRuns = 10000, double maxSeconds = 5.0,
+                          double relConfidence = 0.01) {
+  SuppressOutput suppressOutput;
+  const auto benchStart = std::chrono::steady_clock::now();
+  auto secondsSince = [](const auto &start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         start)
+        .count();
+  };
+  for (int i = 0; i < warmUps && secondsSince(benchStart) < maxSeconds / 4.0;
+       ++i) {
+    func();
+  }
+  std::vector<double> samplesMs;
+  BenchmarkResult res;
+  do {
+    const auto start = std::chrono::steady_clock::now();
+    func();
+    samplesMs.push_back(secondsSince(start) * 1000.0);
+    if (samplesMs.size() >= 2) {
+      res = evalSamples(samplesMs);
+      const double ciHalfWidth = 1.96 * res.stddevMs / std::sqrt(res.runs);
+      if (res.runs >= minRuns && ciHalfWidth <= relConfidence * res.meanMs) {
+        break;
+      }
+    }
+  } while (samplesMs.size() < maxRuns && secondsSince(benchStart) < maxSeconds);
+  return evalSamples(samplesMs);
+}
+
+inline void printBenchmarkResult(const BenchmarkResult &res,
+                                 const std::string &name) {
+  std::cout << std::setprecision(6) << name << " benchmark: " << res.runs
+            << " runs, min " << res.minMs << " ms, median " << res.medianMs
+            << " ms, mean " << res.meanMs << " ms, p99 " << res.p99Ms
+            << " ms, stddev " << res.stddevMs << " ms\n";
+  std::cout << "{\"name\": \"" << name << "\", \"runs\": " << res.runs
+            << ", \"min_ms\": " << res.minMs
+            << ", \"median_ms\": " << res.medianMs
+            << ", \"mean_ms\": " << res.meanMs << ", \"p99_ms\": " << res.p99Ms
+            << ", \"stddev_ms\": " << res.stddevMs << "}\n";
+}
+
 template <typename Func>
 void measureTime(Func func, const std::string &name, int repetitions = 1) {
   std::cout << "Running " << name << "...\n";
@@ -102,6 +221,9 @@ void measureTime(Func func, const std::string &name, int repetitions = 1) {
                   static_cast<double>(repetitions))
               << " ms\n";
   }
+  if (benchmarkEnabled()) {
+    printBenchmarkResult(benchmark(func), name);
+  }
 }
 
 inline std::ostream &operator<<(std::ostream &os,
@@ -141,4 +263,84 @@ std::vector<std::vector<T>> parseCSVNumbers(std::ifstream &ifs,
     ret.emplace_back(std::move(nums));
   }
   return ret;
-}
\ No newline at end of file
+}
+
+// 2D map in one row major buffer.
+// It can be surrounded by a border of padding cells with a sentinel value.
+// Then the neighbours of all inner cells can be accessed without checking the
+// bounds.
+// Row and col are relative to the inner cells. So the border cells have
+// negative coords or coords >= rows / cols.
+template <typename T> struct Grid {
+  Grid() = default;
+  Grid(int rows_, int cols_, const T &value = T(), int padding_ = 0,
+       const T &border = T())
+      : rows(rows_), cols(cols_), padding(padding_),
+        stride(cols_ + 2 * padding_),
+        cells(static_cast<size_t>(rows_ + 2 * padding_) * stride, border) {
+    for (int row = 0; row < rows; ++row) {
+      std::fill_n(&cells[index(row, 0)], cols, value);
+    }
+  }
+
+  // Lines can be e.g. std::vector<std::string> or
+  // std::vector<std::string_view>.
+  // T needs to be constructible from char.
+  template <typename Lines>
+  static Grid<T> fromLines(const Lines &lines, int padding = 0,
+                           const T &border = T()) {
+    const int numRows = lines.size();
+    const int numCols = lines.empty() ? 0 : lines[0].size();
+    Grid<T> grid(numRows, numCols, T(), padding, border);
+    for (int row = 0; row < numRows; ++row) {
+      for (int col = 0; col < numCols; ++col) {
+        grid(row, col) = T(lines[row][col]);
+      }
+    }
+    return grid;
+  }
+
+  size_t index(int row, int col) const {
+    return static_cast<size_t>(row + padding) * stride + (col + padding);
+  }
+  template <typename U> size_t index(const Coords_<U> &coords) const {
+    return index(coords.row, coords.col);
+  }
+  Coords_<int> coords(size_t index) const {
+    return Coords_<int>(index / stride - padding, index % stride - padding);
+  }
+  // Add this to a linear index to get to the neighbour in direction dir.
+  template <typename U> std::ptrdiff_t offset(const Coords_<U> &dir) const {
+    return static_cast<std::ptrdiff_t>(dir.row) * stride + dir.col;
+  }
+  // In the order of Coords_::Directions().
+  std::array<std::ptrdiff_t, 4> offsets() const {
+    return {1, -1, -static_cast<std::ptrdiff_t>(stride),
+            static_cast<std::ptrdiff_t>(stride)};
+  }
+
+  T &operator[](size_t index) { return cells[index]; }
+  const T &operator[](size_t index) const { return cells[index]; }
+  T &operator()(int row, int col) { return cells[index(row, col)]; }
+  const T &operator()(int row, int col) const {
+    return cells[index(row, col)];
+  }
+  template <typename U> T &operator()(const Coords_<U> &coords) {
+    return cells[index(coords)];
+  }
+  template <typename U> const T &operator()(const Coords_<U> &coords) const {
+    return cells[index(coords)];
+  }
+
+  Coords_<int> size() const { return Coords_<int>(rows, cols); }
+  template <typename U> bool inBounds(const Coords_<U> &coords) const {
+    return coords.row >= 0 && coords.col >= 0 && coords.row < rows &&
+           coords.col < cols;
+  }
+
+  int rows = 0;
+  int cols = 0;
+  int padding = 0;
+  size_t stride = 0;
+  std::vector<T> cells;
+};
@@ -1,39 +1,64 @@
 #include "utils.h"
+#include <algorithm>
 #include <cassert>
-#include <cmath>
 #include <fstream>
 #include <iostream>
+#include <limits>
+#include <random>
 #include <string>
+#include <utility>
+#include <thread>
+#include <vector>
 
 using num = long long;
 
+// The operands are not negative.
 struct Data {
   num result;
   std::vector<num> operands;
+  // Index after the last operand 0 (0 if there is none).
+  // A multiplication with 0 makes a too large result small again. So the
+  // forward search can only prune from there on.
+  size_t pruneFrom = 0;
 };
 
+Data makeData(num result, std::vector<num> operands) {
+  assert(!operands.empty());
+  Data data;
+  data.result = result;
+  data.operands = std::move(operands);
+  for (size_t i = 0; i < data.operands.size(); ++i) {
+    assert(data.operands[i] >= 0);
+    if (data.operands[i] == 0) {
+      data.pruneFrom = i + 1;
+    }
+  }
+  return data;
+}
+
 std::vector<Data> parseFile(std::ifstream &ifs) {
   std::vector<Data> data;
   std::string line;
   num row = 0;
   while (std::getline(ifs, line)) {
     const auto posSeparator = line.find(':');
-    Data parsed;
-    parsed.result = std::stoll(line.substr(0, posSeparator));
-    parsed.operands = parseCSVLine<num>(line.substr(posSeparator + 2), ' ');
-    assert(!parsed.operands.empty());
-    data.emplace_back(std::move(parsed));
+    data.push_back(
+        makeData(std::stoll(line.substr(0, posSeparator)),
+                 parseCSVLine<num>(line.substr(posSeparator + 2), ' ')));
   }
   return data;
 }
 
-bool solve(const Data &line, num result, int opIndex);
-
 template <typename Func>
 bool solveWithResult(const Data &line, num computedResult, int opIndex,
                      Func solveImpl) {
   if (computedResult > line.result) {
-    return false;
+    if (static_cast<size_t>(opIndex) + 1 >= line.pruneFrom) {
+      return false;
+    }
+    // All results above line.result behave the same until the multiplication
+    // with 0. This one does not overflow.
+    computedResult = line.result + 1;
   }
   if (opIndex + 1 >= line.operands.size()) {
     return computedResult == line.result;
@@ -49,67 +74,201 @@ bool solveImpl1(const Data &line, num result, int opIndex) {
          solveWithResult(line, resultSum, opIndex, solveImpl1);
 }
 
+// Smallest power of 10 greater than operand.
+num nextPow10(num operand) { return powerOf10(getNumDigits(operand)); }
+
 num concat(num result, num operand) {
-  const num log = static_cast<num>(std::log10(operand));
-  num p = std::pow(10, log);
-  while (p <= operand) {
-    p *= 10;
-  }
   // clang-format off
-  //std::cout << result << " || " << operand << " = " << p * result + operand << " (log = " << log << ", p = " << p << "\n";
+  //std::cout << result << " || " << operand << " = " << nextPow10(operand) * result + operand << "\n";
   //  clang-format on
-  return p * result + operand;
+  return nextPow10(operand) * result + operand;
 }
 
 bool solveImpl2(const Data &line, num result, int opIndex) {
   const num operand = line.operands[opIndex];
   const num resultProduct = result * operand;
   const num resultSum = result + operand;
-  const num log = std::log10(result);
   const num resultConcat = concat(result, operand);
   return solveWithResult(line, resultProduct, opIndex, solveImpl2) ||
          solveWithResult(line, resultSum, opIndex, solveImpl2) ||
          solveWithResult(line, resultConcat, opIndex, solveImpl2);
 }
 
-template <typename Func> bool solve(const Data &line, Func solveImpl) {
+// Reverse search: Starts from the result and undoes the operators from the
+// last operand on.
+// Most branches end immediately because the division is not exact or the
+// result does not end with the digits of the operand.
+template <typename Func>
+bool unsolveWithRemainder(const Data &line, num remainder, int opIndex,
+                          Func unsolveImpl) {
+  if (opIndex == 1) {
+    return remainder == line.operands[0];
+  }
+  return unsolveImpl(line, remainder, opIndex - 1);
+}
+
+// Multiplying any prefix with 0 gives 0.
+bool isZeroProduct(num remainder, num operand) {
+  return operand == 0 && remainder == 0;
+}
+
+bool unsolveImpl1(const Data &line, num remainder, int opIndex) {
+  const num operand = line.operands[opIndex];
+  return isZeroProduct(remainder, operand) ||
+         (operand != 0 && remainder % operand == 0 &&
+          unsolveWithRemainder(line, remainder / operand, opIndex,
+                               unsolveImpl1)) ||
+         (remainder >= operand &&
+          unsolveWithRemainder(line, remainder - operand, opIndex,
+                               unsolveImpl1));
+}
+
+bool unsolveImpl2(const Data &line, num remainder, int opIndex) {
+  const num operand = line.operands[opIndex];
+  const num p = nextPow10(operand);
+  return isZeroProduct(remainder, operand) ||
+         (operand != 0 && remainder % operand == 0 &&
+          unsolveWithRemainder(line, remainder / operand, opIndex,
+                               unsolveImpl2)) ||
+         (remainder >= operand &&
+          unsolveWithRemainder(line, remainder - operand, opIndex,
+                               unsolveImpl2)) ||
+         (remainder % p == operand &&
+          unsolveWithRemainder(line, remainder / p, opIndex, unsolveImpl2));
+}
+
+enum class Direction { FORWARD, REVERSE };
+
+template <typename Func>
+bool solve(const Data &line, Func solveImpl, Direction dir) {
   assert(line.operands.size() >= 1);
-  const num result = line.operands[0];
-  if (line.operands.size() > 1) {
-    return solveImpl(line, result, 1);
-  } else {
-    return result == line.result;
+  if (line.operands.size() == 1) {
+    return line.operands[0] == line.result;
   }
+  if (dir == Direction::FORWARD) {
+    return solveImpl(line, line.operands[0], 1);
+  }
+  return solveImpl(line, line.result, line.operands.size() - 1);
 }
 
-void solvePart1(const std::vector<Data> &data) {
-  num sum = 0;
-  for (Data line : data) {
-    if (solve(line, solveImpl1)) {
-      sum += line.result;
+// Equations are solved independently on one thread per core.
+template <typename Func>
+num sumSolvable(const std::vector<Data> &data, Func solveImpl, Direction dir,
+                unsigned numThreads) {
+  numThreads = std::max(1u, numThreads);
+  std::vector<num> sums(numThreads, 0);
+  auto work = [&](unsigned t) {
+    num sum = 0;
+    // Interleaved so that expensive equations next to each other are spread.
+    for (size_t i = t; i < data.size(); i += numThreads) {
+      const auto &line = data[i];
+      if (solve(line, solveImpl, dir)) {
+        assert(line.result <= std::numeric_limits<num>::max() - sum);
+        sum += line.result;
+      }
     }
+    sums[t] = sum;
+  };
+  std::vector<std::thread> threads;
+  for (unsigned t = 1; t < numThreads; ++t) {
+    threads.emplace_back(work, t);
+  }
+  work(0);
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  num sum = 0;
+  for (const num s : sums) {
+    sum += s;
   }
-  std::cout << sum << "\n";
+  return sum;
 }
 
-void solvePart2(const std::vector<Data> &data) {
-  num sum = 0;
-  for (Data line : data) {
-    if (solve(line, solveImpl2)) {
-      num before = sum;
-      sum += line.result;
-      assert(sum > before);
+void solvePart1(const std::vector<Data> &data,
+                Direction dir = Direction::REVERSE,
+                unsigned numThreads = std::thread::hardware_concurrency()) {
+  const auto impl = dir == Direction::FORWARD ? solveImpl1 : unsolveImpl1;
+  std::cout << sumSolvable(data, impl, dir, numThreads) << "\n";
+}
+
+void solvePart2(const std::vector<Data> &data,
+                Direction dir = Direction::REVERSE,
+                unsigned numThreads = std::thread::hardware_concurrency()) {
+  const auto impl = dir == Direction::FORWARD ? solveImpl2 : unsolveImpl2;
+  std::cout << sumSolvable(data, impl, dir, numThreads) << "\n";
+}
+
+// Random equations, half of them solvable with both operator sets.
+std::vector<Data> generateData(int numLines, int numOperands,
+                               std::mt19937 &rng) {
+  constexpr num MAX_RESULT = 1'000'000'000'000'000;
+  std::vector<Data> data;
+  for (int l = 0; l < numLines; ++l) {
+    std::vector<num> operands = {static_cast<num>(1 + rng() % 9)};
+    num result = operands[0];
+    for (int i = 1; i < numOperands; ++i) {
+      const num operand = 1 + rng() % 9;
+      operands.push_back(operand);
+      // Mostly additions to stay in range.
+      result = (rng() % 4 == 0 && result * operand < MAX_RESULT)
+                   ? result * operand
+                   : result + operand;
+    }
+    if (rng() % 2 == 0) {
+      ++result;
     }
+    data.push_back(makeData(result, std::move(operands)));
+  }
+  return data;
+}
+
+// Compares the forward and reverse search on long equations.
+void benchmarkDirections() {
+  std::mt19937 rng(7);
+  const auto data = generateData(100, 20, rng);
+  for (const auto dir : {Direction::FORWARD, Direction::REVERSE}) {
+    const std::string name =
+        dir == Direction::FORWARD ? " forward" : " reverse";
+    printBenchmarkResult(benchmark([&data, dir]() { solvePart1(data, dir); }),
+                         "Part 1" + name + " 20 operands");
+    printBenchmarkResult(benchmark([&data, dir]() { solvePart2(data, dir); }),
+                         "Part 2" + name + " 20 operands");
   }
-  std::cout << sum << "\n";
 }
 
+// Scaling of the reverse search from one thread to one per core.
+void benchmarkThreads() {
+  std::mt19937 rng(7);
+  const auto data = generateData(100000, 12, rng);
+  const unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+  for (unsigned numThreads = 1; numThreads <= maxThreads; ++numThreads) {
+    printBenchmarkResult(
+        benchmark([&data, numThreads]() {
+          solvePart2(data, Direction::REVERSE, numThreads);
+        }),
+        "Part 2 " + std::to_string(numThreads) + " threads");
+  }
+}
+
+#ifdef AOC_RUNNER
+AOC_REGISTER(7, 1, [](std::ifstream &ifs) { solvePart1(parseFile(ifs)); });
+AOC_REGISTER(7, 2, [](std::ifstream &ifs) { solvePart2(parseFile(ifs)); });
+#else
 int main() {
   std::ifstream ifs("input.txt");
   // std::ifstream ifs("input_test.txt");
   const auto data = parseFile(ifs);
+  measureTime([&data]() { solvePart1(data, Direction::FORWARD); },
+              "Part 1 (forward)");
   measureTime([&data]() { solvePart1(data); }, "Part 1");
+  measureTime([&data]() { solvePart2(data, Direction::FORWARD); },
+              "Part 2 (forward)");
   measureTime([&data]() { solvePart2(data); }, "Part 2");
+  if (benchmarkEnabled()) {
+    benchmarkDirections();
+    benchmarkThreads();
+  }
   std::cout << "Done.\n";
   return 0;
-}
\ No newline at end of file
+}
+#endif
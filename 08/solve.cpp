@@ -1,22 +1,88 @@
 #include "utils.h"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
-#include <map>
-#include <set>
-#include <unordered_set>
+#include <limits>
 #include <string>
+#include <utility>
+#include <vector>
 
 using Coords = Coords_<int>;
 
+// Frequencies are digits, upper and lower case letters.
+constexpr int NUM_FREQS = 10 + 26 + 26;
+
+int freqIndex(char ch) {
+  if (isDigit(ch)) {
+    return ch - '0';
+  }
+  if ('A' <= ch && ch <= 'Z') {
+    return 10 + (ch - 'A');
+  }
+  assert('a' <= ch && ch <= 'z');
+  return 10 + 26 + (ch - 'a');
+}
+
+char freqChar(int index) {
+  if (index < 10) {
+    return '0' + index;
+  }
+  if (index < 10 + 26) {
+    return 'A' + (index - 10);
+  }
+  return 'a' + (index - 10 - 26);
+}
+
 struct Data {
   Coords size;
-  std::map<char, std::vector<Coords>> coordsByFreq;
+  std::array<std::vector<Coords>, NUM_FREQS> coordsByFreq;
+};
+
+// One bit per cell of the map.
+class CellSet {
+public:
+  explicit CellSet(const Coords &size_)
+      : cols(size_.col),
+        bits((static_cast<size_t>(size_.row) * size_.col + 63) / 64, 0) {}
+
+  size_t index(const Coords &coords) const {
+    return static_cast<size_t>(coords.row) * cols + coords.col;
+  }
+
+  std::ptrdiff_t offset(const Coords &dir) const {
+    return static_cast<std::ptrdiff_t>(dir.row) * cols + dir.col;
+  }
+
+  void insert(size_t index) {
+    bits[index / 64] |= uint64_t(1) << (index % 64);
+  }
+
+  void insert(const Coords &coords) { insert(index(coords)); }
+
+  size_t size() const {
+    size_t count = 0;
+    for (const uint64_t word : bits) {
+      count += __builtin_popcountll(word);
+    }
+    return count;
+  }
+
+private:
+  int cols;
+  std::vector<uint64_t> bits;
 };
 
 void printData(const Data &data) {
-  for (const auto &pair : data.coordsByFreq) {
-    std::cout << pair.first << ": ";
-    for (const auto &coords : pair.second) {
+  for (int f = 0; f < NUM_FREQS; ++f) {
+    if (data.coordsByFreq[f].empty()) {
+      continue;
+    }
+    std::cout << freqChar(f) << ": ";
+    for (const auto &coords : data.coordsByFreq[f]) {
       std::cout << "(" << coords.row << ", " << coords.col << "), ";
     }
     std::cout << "\n";
@@ -33,7 +99,7 @@ Data parseFile(std::ifstream &ifs) {
     for (int col = 0; col < line.size(); ++col) {
       const char ch = line[col];
       if (ch != '.') {
-        data.coordsByFreq[ch].emplace_back(row, col);
+        data.coordsByFreq[freqIndex(ch)].emplace_back(row, col);
       }
     }
     ++row;
@@ -45,9 +111,8 @@ Data parseFile(std::ifstream &ifs) {
 
 void solvePart1(const Data &data) {
   const Coords size = data.size;
-  std::set<Coords> knownAntiNodes;
-  for (const auto &pair : data.coordsByFreq) {
-    const auto &coords = pair.second;
+  CellSet knownAntiNodes(size);
+  for (const auto &coords : data.coordsByFreq) {
     for (int i = 0; i < coords.size(); ++i) {
       for (int j = 0; j < coords.size(); ++j) {
         if (i != j) {
@@ -65,48 +130,62 @@ void solvePart1(const Data &data) {
   std::cout << knownAntiNodes.size() << "\n";
 }
 
-// Euclidean algorithm
+// Binary GCD (Stein's algorithm).
 int ggt(int a, int b) {
   if (a == 0) {
     return b;
-  } else {
-    while (b != 0) {
-      if (a > b) {
-        a = a - b;
-      } else {
-        b = b - a;
-      }
-    }
+  }
+  if (b == 0) {
     return a;
   }
+  const int shift = __builtin_ctz(a | b);
+  a >>= __builtin_ctz(a);
+  do {
+    b >>= __builtin_ctz(b);
+    if (a > b) {
+      std::swap(a, b);
+    }
+    b -= a;
+  } while (b != 0);
+  return a << shift;
 }
 
 Coords reduce(const Coords &coords) {
   return coords / ggt(std::abs(coords.row), std::abs(coords.col));
 }
 
+int floorDiv(int a, int b) {
+  return a / b - (a % b != 0 && (a < 0) != (b < 0));
+}
+
+// Narrows [*sMin, *sMax] to the s for which 0 <= start + s * step < size.
+void clampSteps(int start, int step, int size, int *sMin, int *sMax) {
+  if (step > 0) {
+    *sMin = std::max(*sMin, -floorDiv(start, step));
+    *sMax = std::min(*sMax, floorDiv(size - 1 - start, step));
+  } else if (step < 0) {
+    *sMin = std::max(*sMin, -floorDiv(size - 1 - start, -step));
+    *sMax = std::min(*sMax, floorDiv(start, -step));
+  }
+}
+
+// Each pair of antennas marks its whole line in both directions at once.
 void solvePart2(const Data &data) {
   const Coords size = data.size;
-  std::set<Coords> knownAntiNodes;
-  for (const auto &pair : data.coordsByFreq) {
-    const auto &coords = pair.second;
+  CellSet knownAntiNodes(size);
+  for (const auto &coords : data.coordsByFreq) {
     for (int i = 0; i < coords.size(); ++i) {
-      for (int j = 0; j < coords.size(); ++j) {
-        if (i != j) {
-          const auto &coordsI = coords[i];
-          const auto &coordsJ = coords[j];
-          const Coords diff = reduce(coordsJ - coordsI);
-          Coords coordsAntiNode = coordsJ;
-          int s = 0;
-          while (true) {
-            const auto coordsAntiNode = coordsJ + (diff * s);
-            if (inBounds(coordsAntiNode, data.size)) {
-              knownAntiNodes.insert(coordsAntiNode);
-              ++s;
-            } else {
-              break;
-            }
-          }
+      for (int j = i + 1; j < coords.size(); ++j) {
+        const auto &coordsI = coords[i];
+        const Coords diff = reduce(coords[j] - coordsI);
+        int sMin = std::numeric_limits<int>::min();
+        int sMax = std::numeric_limits<int>::max();
+        clampSteps(coordsI.row, diff.row, size.row, &sMin, &sMax);
+        clampSteps(coordsI.col, diff.col, size.col, &sMin, &sMax);
+        const std::ptrdiff_t step = knownAntiNodes.offset(diff);
+        std::ptrdiff_t index = knownAntiNodes.index(coordsI) + sMin * step;
+        for (int s = sMin; s <= sMax; ++s, index += step) {
+          knownAntiNodes.insert(index);
         }
       }
     }
@@ -114,6 +193,10 @@ void solvePart2(const Data &data) {
   std::cout << knownAntiNodes.size() << "\n";
 }
 
+#ifdef AOC_RUNNER
+AOC_REGISTER(8, 1, [](std::ifstream &ifs) { solvePart1(parseFile(ifs)); });
+AOC_REGISTER(8, 2, [](std::ifstream &ifs) { solvePart2(parseFile(ifs)); });
+#else
 int main() {
   std::ifstream ifs("input.txt");
   // std::ifstream ifs("input_test.txt");
@@ -122,4 +205,5 @@ int main() {
   measureTime([&data]() { solvePart2(data); }, "Part 2");
   std::cout << "Done.\n";
   return 0;
-}
\ No newline at end of file
+}
+#endif
@@ -2,8 +2,10 @@
 #include <cassert>
 #include <fstream>
 #include <iostream>
-#include <list>
+#include <queue>
 #include <string>
+#include <string_view>
+#include <vector>
 
 using num = long long;
 
@@ -94,44 +96,149 @@ void solvePart1(const Data &data) {
   std::cout << computeCheckSum(defragmentedFiles) << "\n";
 }
 
-// This is really not a fast solution.
-// But I am already behind one day so I keep this.
+// Same as solvePart1 but directly on the disk map without building any
+// files. Consumes the disk map from both ends at once and accumulates the
+// checksum on the fly with O(1) memory.
+// Works for disk maps larger than the RAM when they are memory mapped.
+num streamCheckSum(std::string_view diskMap) {
+  while (!diskMap.empty() && !isDigit(diskMap.back())) {
+    diskMap.remove_suffix(1); // Trailing newline.
+  }
+  if (diskMap.empty()) {
+    return 0;
+  }
+  auto chunkSize = [diskMap](size_t i) -> num { return diskMap[i] - '0'; };
+  size_t left = 0;
+  // Last file chunk. Files are at even indices.
+  size_t right = (diskMap.size() - 1) & ~static_cast<size_t>(1);
+  num rightRemaining = chunkSize(right);
+  num pos = 0;
+  num checkSum = 0;
+  while (left < right) {
+    if (left % 2 == 0) {
+      // File stays where it is.
+      const num size = chunkSize(left);
+      checkSum += static_cast<num>(left / 2) * sumSeq(pos, pos + size);
+      pos += size;
+    } else {
+      // Fill gap from the back.
+      num freeSpace = chunkSize(left);
+      while (freeSpace > 0 && left < right) {
+        const num occupyingSpace = std::min(freeSpace, rightRemaining);
+        checkSum += static_cast<num>(right / 2) *
+                    sumSeq(pos, pos + occupyingSpace);
+        pos += occupyingSpace;
+        freeSpace -= occupyingSpace;
+        rightRemaining -= occupyingSpace;
+        if (rightRemaining == 0) {
+          right -= 2;
+          rightRemaining = chunkSize(right);
+        }
+      }
+    }
+    ++left;
+  }
+  if (left == right) {
+    // Whatever is left of the file both ends met at.
+    checkSum += static_cast<num>(right / 2) * sumSeq(pos, pos + rightRemaining);
+  }
+  return checkSum;
+}
+
+void solvePart1Streaming(std::string_view diskMap) {
+  std::cout << streamCheckSum(diskMap) << "\n";
+}
+
+// Free spans indexed by their size.
+// For each size (usually 1 - 9) a min heap of the start positions of the gaps
+// with that size. The leftmost fitting gap for a file is the smallest top of
+// the heaps of sizes >= file size.
+using GapHeap = std::priority_queue<num, std::vector<num>, std::greater<num>>;
+using GapIndex = std::vector<GapHeap>;
+
+GapIndex inputToGaps(const Data &data) {
+  std::vector<std::vector<num>> gapStartsBySize(10);
+  bool chunkIsFile = true;
+  num pos = 0;
+  // Gaps separated only by empty files are one gap.
+  num gapStart = 0;
+  size_t gapSize = 0;
+  for (size_t i = 0; i < data.line.size(); ++i) {
+    const num chunkSize = data.line[i] - '0';
+    if (chunkIsFile && chunkSize > 0) {
+      if (gapSize > 0) {
+        if (gapSize >= gapStartsBySize.size()) {
+          gapStartsBySize.resize(gapSize + 1);
+        }
+        gapStartsBySize[gapSize].push_back(gapStart);
+      }
+      gapSize = 0;
+    } else if (!chunkIsFile && chunkSize > 0) {
+      if (gapSize == 0) {
+        gapStart = pos;
+      }
+      gapSize += chunkSize;
+    }
+    pos += chunkSize;
+    chunkIsFile = !chunkIsFile;
+  }
+  GapIndex gaps(gapStartsBySize.size());
+  for (size_t size = 1; size < gaps.size(); ++size) {
+    // Construct from vector at once which is O(n) instead of O(n log n).
+    gaps[size] =
+        GapHeap(std::greater<num>(), std::move(gapStartsBySize[size]));
+  }
+  return gaps;
+}
+
 void solvePart2(const Data &data) {
-  auto fragmentedFiles = inputToFiles(data);
-  std::list<File> files;
-  std::copy(fragmentedFiles.begin(), fragmentedFiles.end(),
-            std::back_inserter(files));
-  for (auto srcIt = files.rbegin(); srcIt != files.rend();) {
-    auto srcItFwd = std::next(srcIt).base();
-    bool erased = false;
-    for (auto destPrevIt = files.begin(); destPrevIt != srcItFwd;
-         ++destPrevIt) {
-      auto destIt = std::next(destPrevIt);
-      num freeSpace = destIt->start - (destPrevIt->start + destPrevIt->size);
-      if (freeSpace >= srcIt->size) {
-        files.insert(
-            destIt,
-            File(srcIt->id, destPrevIt->start + destPrevIt->size, srcIt->size));
-        auto erasedIt = files.erase(srcItFwd);
-        srcIt = std::make_reverse_iterator(erasedIt);
-        erased = true;
-        break;
+  auto files = inputToFiles(data);
+  auto gaps = inputToGaps(data);
+  for (auto fileIt = files.rbegin(); fileIt != files.rend(); ++fileIt) {
+    File &file = *fileIt;
+    size_t bestGapSize = 0;
+    num bestGapStart = file.start; // Only move files to the left.
+    for (size_t size = file.size; size < gaps.size(); ++size) {
+      if (!gaps[size].empty() && gaps[size].top() < bestGapStart) {
+        bestGapStart = gaps[size].top();
+        bestGapSize = size;
       }
     }
-    if (!erased) {
-      ++srcIt;
+    if (bestGapSize > 0) {
+      gaps[bestGapSize].pop();
+      file.start = bestGapStart;
+      const num remainingSize = static_cast<num>(bestGapSize) - file.size;
+      if (remainingSize > 0) {
+        gaps[remainingSize].push(bestGapStart + file.size);
+      }
+      // The space freed by the file is never used because all files that
+      // are still to move lie to the left of it.
     }
   }
   // printFiles(files);
   std::cout << computeCheckSum(files) << "\n";
 }
 
+#ifdef AOC_RUNNER
+AOC_REGISTER(9, 1, [](const std::string &path) {
+  const MappedFile file(path);
+  solvePart1Streaming(file.text());
+});
+AOC_REGISTER_HEAVY(9, 2,
+                   [](std::ifstream &ifs) { solvePart2(parseFile(ifs)); });
+#else
 int main() {
   std::ifstream ifs("input.txt");
   // std::ifstream ifs("input_test.txt");
   const auto data = parseFile(ifs);
+  const MappedFile file("input.txt");
+  // const MappedFile file("input_test.txt");
+  const std::string_view diskMap = file.text();
   measureTime([&data]() { solvePart1(data); }, "Part 1");
+  measureTime([diskMap]() { solvePart1Streaming(diskMap); },
+              "Part 1 (streaming)");
   measureTime([&data]() { solvePart2(data); }, "Part 2");
   std::cout << "Done.\n";
   return 0;
-}
\ No newline at end of file
+}
+#endif
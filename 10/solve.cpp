@@ -1,103 +1,129 @@
 #include "utils.h"
+#include <array>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
 #include <string>
-#include <unordered_map>
-#include <set>
+#include <vector>
 
 using Coords = Coords_<int>;
 
 struct Data {
-  std::vector<std::string> lines;
+  // Padded with a border that never matches a height.
+  // So the neighbours of all cells can be accessed without bounds check.
+  Grid<char> grid;
 };
 
-Data parseFile(std::ifstream &ifs) {
+Data parseFile(const MappedFile &file) {
   Data data;
-  std::string line;
-  while (std::getline(ifs, line)) {
-    data.lines.push_back(line);
-  }
+  data.grid = Grid<char>::fromLines(file.lines(), 1);
   return data;
 }
 
-struct Cell {
-  int preds = 0;
-  std::set<Coords> heads;
-};
-
-using CandidatesMap = std::unordered_map<Coords, Cell, CoordsHash>;
+// Linear indices of the cells of each height.
+using HeightBuckets = std::array<std::vector<size_t>, 10>;
 
-CandidatesMap extractInitialCandidates(const Data &data) {
-  CandidatesMap candidates;
-  for (int row = 0; row < data.lines.size(); ++row) {
-    for (int col = 0; col < data.lines[row].size(); ++col) {
-      if (data.lines[row][col] == '0') {
-        Cell cell{1};
-        cell.heads.insert(Coords(row, col));
-        candidates[Coords(row, col)] = cell;
+HeightBuckets bucketByHeight(const Grid<char> &grid) {
+  HeightBuckets buckets;
+  for (int row = 0; row < grid.rows; ++row) {
+    for (int col = 0; col < grid.cols; ++col) {
+      const char ch = grid(row, col);
+      if (isDigit(ch)) {
+        buckets[ch - '0'].push_back(grid.index(row, col));
       }
     }
   }
-  return candidates;
+  return buckets;
 }
 
-void getConnectedCoords(const Coords &coords, const Coords &bounds,
-                        std::vector<Coords> &neighbors) {
-  neighbors.clear();
-  if (coords.row > 0) {
-    neighbors.emplace_back(coords.row - 1, coords.col);
-  }
-  if (coords.col > 0) {
-    neighbors.emplace_back(coords.row, coords.col - 1);
-  }
-  if (coords.row + 1 < bounds.row) {
-    neighbors.emplace_back(coords.row + 1, coords.col);
-  }
-  if (coords.col + 1 < bounds.col) {
-    neighbors.emplace_back(coords.row, coords.col + 1);
+std::array<std::ptrdiff_t, 4> makeDirs(const Grid<char> &grid) {
+  return {grid.offset(Coords(-1, 0)), grid.offset(Coords(0, -1)),
+          grid.offset(Coords(1, 0)), grid.offset(Coords(0, 1))};
+}
+
+// Number of distinct peaks reachable from each trailhead.
+// One DFS per trailhead marks the visited cells with its own epoch. So the
+// memory stays at one counter per cell no matter how many trailheads there
+// are.
+int sumScores(const Grid<char> &grid, const HeightBuckets &buckets) {
+  const auto dirs = makeDirs(grid);
+  std::vector<uint32_t> visited(grid.cells.size(), 0);
+  std::vector<size_t> stack;
+  stack.reserve(grid.cells.size());
+  uint32_t epoch = 0;
+  int score = 0;
+  for (const size_t head : buckets[0]) {
+    ++epoch;
+    visited[head] = epoch;
+    stack.push_back(head);
+    while (!stack.empty()) {
+      const size_t index = stack.back();
+      stack.pop_back();
+      const char ch = grid[index];
+      if (ch == '9') {
+        ++score;
+        continue;
+      }
+      for (const auto dir : dirs) {
+        const size_t neighbor = index + dir;
+        if (grid[neighbor] == ch + 1 && visited[neighbor] != epoch) {
+          visited[neighbor] = epoch;
+          stack.push_back(neighbor);
+        }
+      }
+    }
   }
+  return score;
 }
 
-void solvePart1And2(const Data &data) {
-  assert(!data.lines.empty());
-  assert(!data.lines[0].empty());
-  const Coords bounds(data.lines.size(), data.lines[0].size());
-  auto candidates = extractInitialCandidates(data);
-  std::vector<Coords> candidateNeighborCoords; // Reused.
-  for (int i = 0; i < 9; ++i) {
-    int nextNum = i + 1;
-    char nextChar = '0' + nextNum;
-    CandidatesMap nextCandidates;
-    for (const auto &candidatePair : candidates) {
-      const Coords coords = candidatePair.first;
-      const Cell &cell = candidatePair.second;
-      getConnectedCoords(coords, bounds, candidateNeighborCoords);
-      for (const auto neighborCoords : candidateNeighborCoords) {
-        if (data.lines[neighborCoords.row][neighborCoords.col] == nextChar) {
-          nextCandidates[neighborCoords].preds += cell.preds;
-          nextCandidates[neighborCoords].heads.insert(cell.heads.begin(), cell.heads.end());
+// Number of trails to each cell, propagated one height after another.
+uint64_t sumRatings(const Grid<char> &grid, const HeightBuckets &buckets) {
+  const auto dirs = makeDirs(grid);
+  std::vector<uint64_t> trails(grid.cells.size(), 0);
+  for (const size_t head : buckets[0]) {
+    trails[head] = 1;
+  }
+  for (int height = 0; height < 9; ++height) {
+    const char nextChar = '0' + height + 1;
+    for (const size_t index : buckets[height]) {
+      for (const auto dir : dirs) {
+        const size_t neighbor = index + dir;
+        if (grid[neighbor] == nextChar) {
+          trails[neighbor] += trails[index];
         }
       }
     }
-    candidates = std::move(nextCandidates);
   }
-  int score = 0;
-  int sum = 0;
-  for (const auto &sol : candidates) {
-    sum += sol.second.preds;
-    score += sol.second.heads.size();
+  uint64_t sum = 0;
+  for (const size_t peak : buckets[9]) {
+    sum += trails[peak];
   }
-  std::cout << score << "\n";
-  std::cout << sum << "\n";
+  return sum;
 }
 
+void solvePart1And2(const Data &data) {
+  assert(data.grid.rows > 0);
+  assert(data.grid.cols > 0);
+  const auto buckets = bucketByHeight(data.grid);
+  std::cout << sumScores(data.grid, buckets) << "\n";
+  std::cout << sumRatings(data.grid, buckets) << "\n";
+}
+
+#ifdef AOC_RUNNER
+AOC_REGISTER(10, aoc::PART_BOTH, [](const std::string &path) {
+  const MappedFile file(path);
+  solvePart1And2(parseFile(file));
+});
+#else
 int main() {
-  std::ifstream ifs("input.txt");
-  //std::ifstream ifs("input_test.txt");
-  //std::ifstream ifs("input_test1.txt");
-  const auto data = parseFile(ifs);
+  const MappedFile file("input.txt");
+  // const MappedFile file("input_test.txt");
+  // const MappedFile file("input_test1.txt");
+  const auto data = parseFile(file);
   measureTime([&data]() { solvePart1And2(data); }, "Part 1 + 2");
   std::cout << "Done.\n";
   return 0;
-}
\ No newline at end of file
+}
+#endif
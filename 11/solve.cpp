@@ -3,13 +3,16 @@
 #include <array>
 #include <cassert>
 #include <cmath>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <optional>
 #include <string>
 #include <tuple>
-#include <unordered_map>
+#include <utility>
+#include <vector>
 
 constexpr int ITERATIONS_PART_1 = 25;
 constexpr int ITERATIONS_PART_2 = 75;
@@ -33,26 +36,32 @@ void printStones(const std::vector<num> &stones) {
   std::cout << "\n";
 }
 
-void blink(const std::vector<num> &stones, std::vector<num> &nextStones) {
-  nextStones.clear();
-  for (size_t i = 0; i < stones.size(); ++i) {
-    const auto &stone = stones[i];
-    if (stone == 0) {
-      nextStones.push_back(1);
+// Calls func with the one or two stones which stone turns into.
+template <typename Func> void forEachSuccessor(num stone, Func func) {
+  if (stone == 0) {
+    func(1);
+  } else {
+    const int digits = getNumDigits(stone);
+    if (digits % 2 == 0) {
+      num a, b;
+      std::tie(a, b) = splitNumber(stone, digits / 2);
+      func(a);
+      func(b);
     } else {
-      const int digits = getNumDigits(stone);
-      if (digits % 2 == 0) {
-        num a, b;
-        std::tie(a, b) = splitNumber(stone, digits / 2);
-        nextStones.push_back(a);
-        nextStones.push_back(b);
-      } else {
-        nextStones.push_back(stone * 2024);
-      }
+      func(stone * 2024);
     }
   }
 }
 
+void blink(const std::vector<num> &stones, std::vector<num> &nextStones) {
+  nextStones.clear();
+  for (const num stone : stones) {
+    forEachSuccessor(stone, [&nextStones](num next) {
+      nextStones.push_back(next);
+    });
+  }
+}
+
 // This uses a naive algorithm.
 // Part 2 uses the faster algorithm.
 void solvePart1(const Data &data) {
@@ -71,7 +80,7 @@ void solvePart1(const Data &data) {
 // Data structure requires some forward declaration because of recursion:
 struct Power;
 struct Element;
-using Memory = std::unordered_map<num, std::unique_ptr<Power>>;
+using Memory = FlatHashMap<num, std::unique_ptr<Power>>;
 
 struct Element {
   Element() = default;
@@ -111,8 +120,9 @@ Element::Element(Memory &memory, num base, int iteration_)
   if (powerPtr == nullptr) {
     powerPtr = std::make_unique<Power>(base);
   }
+  // powerPtr may move when the memory grows but the Power stays in place.
   power = powerPtr.get();
-  count = powerPtr->getCount(memory, iteration);
+  count = power->getCount(memory, iteration);
 }
 
 void Element::iterate(Memory &memory) {
@@ -185,6 +195,363 @@ void solvePart2(const Data &data) {
   std::cout << count << "\n";
 }
 
+// Stones with the same value behave the same.
+// So only the number of stones per value is tracked and mapped through one
+// blink after the other.
+// The counts wrap around modulo 2^64 after around 100 blinks.
+using Histogram = FlatHashMap<num, uint64_t>;
+
+// numBytes (optional) is set to the memory of both buffers.
+uint64_t countStonesHistogram(const std::vector<num> &stones, int blinks,
+                              size_t *numBytes = nullptr) {
+  Histogram counts;
+  Histogram nextCounts;
+  for (const num stone : stones) {
+    ++counts[stone];
+  }
+  for (int round = 0; round < blinks; ++round) {
+    nextCounts.clear();
+    counts.forEach([&nextCounts](num stone, uint64_t count) {
+      forEachSuccessor(stone, [&nextCounts, count](num next) {
+        nextCounts[next] += count;
+      });
+    });
+    std::swap(counts, nextCounts);
+  }
+  if (numBytes != nullptr) {
+    // The buffers never shrink.
+    *numBytes = (counts.capacity() + nextCounts.capacity()) *
+                (sizeof(num) + sizeof(uint64_t) + 1);
+  }
+  uint64_t count = 0;
+  counts.forEach([&count](num, uint64_t c) { count += c; });
+  return count;
+}
+
+// Same result as solvePart2 but the number of blinks is not fixed.
+void solvePart2Histogram(const Data &data, int blinks = ITERATIONS_PART_2) {
+  std::cout << countStonesHistogram(data.stones, blinks) << "\n";
+}
+
+// Arithmetic modulo the Mersenne prime 2^61 - 1.
+constexpr uint64_t MOD = (uint64_t(1) << 61) - 1;
+
+uint64_t addMod(uint64_t a, uint64_t b) {
+  const uint64_t sum = a + b;
+  return sum >= MOD ? sum - MOD : sum;
+}
+
+uint64_t subMod(uint64_t a, uint64_t b) { return a >= b ? a - b : a + MOD - b; }
+
+uint64_t mulMod(uint64_t a, uint64_t b) {
+  const unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+  uint64_t r = (static_cast<uint64_t>(product) & MOD) +
+               static_cast<uint64_t>(product >> 61);
+  r = (r & MOD) + (r >> 61);
+  return r >= MOD ? r - MOD : r;
+}
+
+uint64_t powMod(uint64_t base, uint64_t exponent) {
+  uint64_t result = 1;
+  for (; exponent > 0; exponent >>= 1) {
+    if (exponent & 1) {
+      result = mulMod(result, base);
+    }
+    base = mulMod(base, base);
+  }
+  return result;
+}
+
+// The closed set of stone values reachable from the input as sparse
+// transition matrix. Each value turns into one or two others.
+struct Transitions {
+  std::vector<num> values;
+  std::vector<std::array<int, 2>> next; // -1: no second stone
+  std::vector<int> stones;              // Indices of the input stones
+};
+
+Transitions discoverTransitions(const std::vector<num> &stones) {
+  Transitions transitions;
+  FlatHashMap<num, int> indices;
+  const auto indexOf = [&transitions, &indices](num value) {
+    const auto inserted =
+        indices.tryEmplace(value, static_cast<int>(transitions.values.size()));
+    if (inserted.second) {
+      transitions.values.push_back(value);
+    }
+    return *inserted.first;
+  };
+  for (const num stone : stones) {
+    transitions.stones.push_back(indexOf(stone));
+  }
+  // values grows while it is walked.
+  for (size_t i = 0; i < transitions.values.size(); ++i) {
+    std::array<int, 2> next = {-1, -1};
+    int n = 0;
+    forEachSuccessor(transitions.values[i],
+                     [&next, &n, &indexOf](num v) { next[n++] = indexOf(v); });
+    transitions.next.push_back(next);
+  }
+  return transitions;
+}
+
+// Total number of stones (mod MOD) after 0 .. length - 1 blinks.
+std::vector<uint64_t> countSequence(const Transitions &transitions,
+                                    size_t length) {
+  const size_t n = transitions.values.size();
+  // Missing second stones go to a sink at index n which is never counted.
+  std::vector<std::array<int, 2>> next = transitions.next;
+  for (auto &pair : next) {
+    if (pair[1] < 0) {
+      pair[1] = n;
+    }
+  }
+  std::vector<uint64_t> counts(n + 1, 0);
+  std::vector<uint64_t> nextCounts(n + 1);
+  for (const int stone : transitions.stones) {
+    counts[stone] += 1;
+  }
+  std::vector<uint64_t> sequence;
+  for (size_t blinks = 0; blinks < length; ++blinks) {
+    uint64_t total = 0;
+    for (size_t i = 0; i < n; ++i) {
+      total = addMod(total, counts[i]);
+    }
+    sequence.push_back(total);
+    std::fill(nextCounts.begin(), nextCounts.end(), 0);
+    for (size_t i = 0; i < n; ++i) {
+      nextCounts[next[i][0]] = addMod(nextCounts[next[i][0]], counts[i]);
+      nextCounts[next[i][1]] = addMod(nextCounts[next[i][1]], counts[i]);
+    }
+    nextCounts[n] = 0;
+    std::swap(counts, nextCounts);
+  }
+  return sequence;
+}
+
+// Shortest recurrence s[i] = sum_j rec[j] * s[i - 1 - j] of the sequence
+// (Berlekamp-Massey).
+std::vector<uint64_t> findRecurrence(const std::vector<uint64_t> &sequence) {
+  std::vector<uint64_t> current = {1};
+  std::vector<uint64_t> previous = {1};
+  size_t length = 0;
+  size_t shift = 1;
+  uint64_t previousDiscrepancy = 1;
+  for (size_t i = 0; i < sequence.size(); ++i) {
+    uint64_t discrepancy = 0;
+    for (size_t j = 0; j <= length; ++j) {
+      discrepancy = addMod(discrepancy, mulMod(current[j], sequence[i - j]));
+    }
+    if (discrepancy == 0) {
+      ++shift;
+      continue;
+    }
+    const auto before = current;
+    const uint64_t factor =
+        mulMod(discrepancy, powMod(previousDiscrepancy, MOD - 2));
+    current.resize(std::max(current.size(), previous.size() + shift), 0);
+    for (size_t j = 0; j < previous.size(); ++j) {
+      current[j + shift] =
+          subMod(current[j + shift], mulMod(factor, previous[j]));
+    }
+    if (2 * length <= i) {
+      length = i + 1 - length;
+      previous = before;
+      previousDiscrepancy = discrepancy;
+      shift = 1;
+    } else {
+      ++shift;
+    }
+  }
+  std::vector<uint64_t> rec(length);
+  for (size_t j = 0; j < length; ++j) {
+    rec[j] = j + 1 < current.size() ? subMod(0, current[j + 1]) : 0;
+  }
+  return rec;
+}
+
+// Reduces a sum of products without overflow of the accumulator.
+uint64_t reduce128(unsigned __int128 value) {
+  value = (value & MOD) + (value >> 61);
+  uint64_t r = (static_cast<uint64_t>(value) & MOD) +
+               static_cast<uint64_t>(value >> 61);
+  r = (r & MOD) + (r >> 61);
+  return r >= MOD ? r - MOD : r;
+}
+
+// Polynomials modulo the characteristic polynomial of a recurrence, i.e.
+// modulo x^n - sum_j rec[j] * x^(n - 1 - j).
+class RecurrenceRing {
+public:
+  explicit RecurrenceRing(std::vector<uint64_t> rec_) : rec(std::move(rec_)) {
+    const size_t n = rec.size();
+    // x^(n + t) for t = 0 .. n - 2 to reduce products in one pass.
+    std::vector<uint64_t> power(n);
+    for (size_t i = 0; i < n; ++i) {
+      power[i] = rec[n - 1 - i];
+    }
+    for (size_t t = 0; t + 1 < n; ++t) {
+      highPowers.push_back(power);
+      power = mulX(power);
+    }
+  }
+
+  std::vector<uint64_t> mulX(const std::vector<uint64_t> &a) const {
+    const size_t n = rec.size();
+    std::vector<uint64_t> result(n);
+    for (size_t i = 0; i < n; ++i) {
+      const uint64_t shifted = i > 0 ? a[i - 1] : 0;
+      result[i] = addMod(shifted, mulMod(a[n - 1], rec[n - 1 - i]));
+    }
+    return result;
+  }
+
+  std::vector<uint64_t> square(const std::vector<uint64_t> &a) const {
+    const size_t n = rec.size();
+    std::vector<unsigned __int128> product(2 * n - 1, 0);
+    for (size_t i = 0; i < n; ++i) {
+      addScaled(&product, i, a[i], a, i);
+    }
+    // Reduce the terms of x^n and higher with the table.
+    std::vector<unsigned __int128> result(product.begin(),
+                                          product.begin() + n);
+    fold(&result);
+    for (size_t t = 0; t + 1 < n; ++t) {
+      addScaled(&result, 0, reduce128(product[n + t]), highPowers[t], t);
+    }
+    std::vector<uint64_t> reduced(n);
+    for (size_t i = 0; i < n; ++i) {
+      reduced[i] = reduce128(result[i]);
+    }
+    return reduced;
+  }
+
+  // x^exponent by repeated squaring from the highest bit on.
+  std::vector<uint64_t> powerOfX(uint64_t exponent) const {
+    std::vector<uint64_t> result(rec.size(), 0);
+    result[0] = 1;
+    if (exponent == 0) {
+      return result;
+    }
+    for (int bit = 63 - __builtin_clzll(exponent); bit >= 0; --bit) {
+      result = square(result);
+      if ((exponent >> bit) & 1) {
+        result = mulX(result);
+      }
+    }
+    return result;
+  }
+
+private:
+  // Products are below 2^122. So the accumulators can take 32 of them
+  // between two folds.
+  static constexpr size_t FOLD = 32;
+
+  // acc[offset + j] += factor * values[j] and folds all accumulators after
+  // every FOLD steps (counted by step).
+  static void addScaled(std::vector<unsigned __int128> *acc, size_t offset,
+                        uint64_t factor, const std::vector<uint64_t> &values,
+                        size_t step) {
+    if (factor != 0) {
+      for (size_t j = 0; j < values.size(); ++j) {
+        (*acc)[offset + j] +=
+            static_cast<unsigned __int128>(factor) * values[j];
+      }
+    }
+    if (step % FOLD == FOLD - 1) {
+      fold(acc);
+    }
+  }
+
+  static void fold(std::vector<unsigned __int128> *acc) {
+    for (auto &value : *acc) {
+      value = (value & MOD) + (value >> 61);
+    }
+  }
+
+  std::vector<uint64_t> rec;
+  std::vector<std::vector<uint64_t>> highPowers;
+};
+
+// Number of stones (mod 2^61 - 1) after any number of blinks.
+// Raising the transition matrix of the few thousand values to the power of
+// blinks by repeated squaring would cost O(n^3) per squaring. Instead the
+// totals are extended with their shortest linear recurrence, which is found
+// from the first 2 n blinks. Then x^blinks is computed by repeated squaring
+// modulo its characteristic polynomial. That is O(L^2 log(blinks)) with the
+// order L of the recurrence.
+// The result equals the exact count as long as that is below 2^61 - 1 (up to
+// around 100 blinks).
+uint64_t countStonesFastForward(const std::vector<num> &stones,
+                                uint64_t blinks) {
+  const auto transitions = discoverTransitions(stones);
+  // The order of the recurrence is at most the number of values.
+  const uint64_t length = 2 * transitions.values.size() + 2;
+  if (blinks < length) {
+    return countSequence(transitions, blinks + 1).back();
+  }
+  const auto sequence = countSequence(transitions, length);
+  const auto rec = findRecurrence(sequence);
+  const size_t n = rec.size();
+  if (n == 0) {
+    return 0;
+  }
+  const auto result = RecurrenceRing(rec).powerOfX(blinks);
+  uint64_t count = 0;
+  for (size_t i = 0; i < n; ++i) {
+    count = addMod(count, mulMod(result[i], sequence[i]));
+  }
+  return count;
+}
+
+void solvePart2FastForward(const Data &data,
+                           uint64_t blinks = ITERATIONS_PART_2) {
+  std::cout << countStonesFastForward(data.stones, blinks) << "\n";
+}
+
+// Compares the memoised graph with the histogram.
+void benchmarkEngines(const Data &data) {
+  {
+    Memory memory;
+    auto elements = makeInitialElements(memory, data.stones);
+    for (int round = 0; round < ITERATIONS_PART_2; ++round) {
+      for (auto &e : elements) {
+        e.iterate(memory);
+      }
+    }
+    const size_t bytes =
+        memory.size() * sizeof(Power) +
+        memory.capacity() * (sizeof(num) + sizeof(std::unique_ptr<Power>) + 1);
+    std::cout << "Graph: " << memory.size() << " nodes, ~" << bytes / 1024
+              << " KiB\n";
+  }
+  for (const int blinks : {ITERATIONS_PART_2, 1000}) {
+    size_t bytes = 0;
+    countStonesHistogram(data.stones, blinks, &bytes);
+    std::cout << "Histogram " << blinks << " blinks: ~" << bytes / 1024
+              << " KiB\n";
+  }
+  printBenchmarkResult(benchmark([&data]() { solvePart2(data); }),
+                       "Part 2 graph");
+  printBenchmarkResult(benchmark([&data]() { solvePart2Histogram(data); }),
+                       "Part 2 histogram");
+  printBenchmarkResult(
+      benchmark([&data]() { solvePart2Histogram(data, 1000); }),
+      "Histogram 1000 blinks");
+  for (const uint64_t blinks : {uint64_t(1'000'000), uint64_t(1e12)}) {
+    printBenchmarkResult(
+        benchmark([&data, blinks]() { solvePart2FastForward(data, blinks); }),
+        "Fast forward " + std::to_string(blinks) + " blinks");
+  }
+}
+
+// The floating point versions which were used before.
+int getNumDigitsFloat(num n) { return n == 0 ? 1 : std::log10(n) + 1; }
+std::pair<num, num> splitNumberFloat(num n, int rightDigits) {
+  const num div = std::pow(10, rightDigits);
+  return std::pair<num, num>(n / div, n % div);
+}
+
 // Some DIY unit tests.
 void test() {
   assert(getNumDigits(0) == 1);
@@ -206,16 +573,81 @@ void test() {
   assert(splitNumber(10, 1).second == 0);
   assert(splitNumber(99910000, 4).first == 9991);
   assert(splitNumber(99910000, 4).second == 0);
+  // Around all powers of 10.
+  // The floating point versions agree below 10^15. From 10^15 - 1 on log10()
+  // rounds up to the next power. So the string length is the reference.
+  for (int exponent = 1; exponent < 19; ++exponent) {
+    const num p = powerOf10(exponent);
+    for (const num n : {p - 1, p, p + 1}) {
+      assert(getNumDigits(n) == static_cast<int>(std::to_string(n).size()));
+      const auto [left, right] = splitNumber(n, exponent);
+      assert(left * p + right == n);
+      assert(right < p);
+      if (exponent < 15) {
+        assert(getNumDigits(n) == getNumDigitsFloat(n));
+        assert(splitNumber(n, exponent) == splitNumberFloat(n, exponent));
+      }
+    }
+  }
+  assert(getNumDigits(std::numeric_limits<num>::max()) == 19);
+  static_assert(getNumDigits(999'999'999'999'999'999ll) == 18);
+  static_assert(splitNumber(123456, 3).first == 123);
+}
+
+// Compares the integer and floating point digit arithmetic.
+void benchmarkDigits() {
+  std::vector<num> nums;
+  for (num n = 1; n < 1'000'000'000'000'000; n = n * 3 + 1) {
+    nums.push_back(n);
+  }
+  const auto run = [&nums](auto numDigits, auto split) {
+    num sum = 0;
+    for (int i = 0; i < 10000; ++i) {
+      for (const num n : nums) {
+        const int digits = numDigits(n);
+        sum += digits + split(n, digits / 2).first;
+      }
+    }
+    std::cout << sum << "\n";
+  };
+  printBenchmarkResult(benchmark([&run]() {
+                         run(getNumDigitsFloat, splitNumberFloat);
+                       }),
+                       "Digits float");
+  printBenchmarkResult(benchmark([&run]() {
+                         run(getNumDigits<num>, splitNumber<num>);
+                       }),
+                       "Digits integer");
 }
 
+#ifdef AOC_RUNNER
+AOC_REGISTER(11, 1, [](std::ifstream &ifs) { solvePart1(parseFile(ifs)); });
+AOC_REGISTER(11, 2, [](std::ifstream &ifs) { solvePart2(parseFile(ifs)); });
+#else
 int main() {
-  // test();
+  test();
   std::ifstream ifs("input.txt");
   // std::ifstream ifs("input_test.txt");
   // std::ifstream ifs("input_test1.txt");
   const auto data = parseFile(ifs);
   measureTime([&data]() { solvePart1(data); }, "Part 1");
   measureTime([&data]() { solvePart2(data); }, "Part 2");
+  measureTime([&data]() { solvePart2Histogram(data); }, "Part 2 (histogram)");
+  measureTime([&data]() { solvePart2FastForward(data); },
+              "Part 2 (fast forward)");
+  if (benchmarkEnabled()) {
+    benchmarkEngines(data);
+    benchmarkDigits();
+    // The stones of part 1 as realistic keys of the memory.
+    std::vector<num> stones = data.stones;
+    std::vector<num> nextStones;
+    for (int round = 0; round < ITERATIONS_PART_1; ++round) {
+      blink(stones, nextStones);
+      std::swap(stones, nextStones);
+    }
+    benchmarkHashMaps(stones, "num keys");
+  }
   std::cout << "Done.\n";
   return 0;
-}
\ No newline at end of file
+}
+#endif
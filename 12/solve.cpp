@@ -11,20 +11,17 @@ using Coords = Coords_<int>;
 using num = long;
 
 struct Data {
-  std::vector<std::string> lines;
+  GridView grid; // Points into the MappedFile.
   int rows;
   int cols;
 };
 
-Data parseFile(std::ifstream &ifs) {
+Data parseFile(const MappedFile &file) {
   Data data;
-  std::string line;
-  while (std::getline(ifs, line)) {
-    data.lines.push_back(line);
-  }
-  data.rows = data.lines.size();
+  data.grid = GridView(file.text());
+  data.rows = data.grid.rows;
   assert(data.rows > 0);
-  data.cols = data.lines[0].size();
+  data.cols = data.grid.cols;
   return data;
 }
 
@@ -37,23 +34,24 @@ struct Cell {
 };
 
 struct Garden {
-  std::vector<std::vector<Cell>> cells;
+  // Padded with a border that never matches a plant.
+  // So the neighbours of all cells can be accessed without bounds check.
+  Grid<Cell> cells;
   Coords size;
 
-  Garden(const Data &data) : size(data.rows, data.cols) {
-    cells.reserve(data.rows);
+  Garden(const Data &data)
+      : cells(data.rows, data.cols, Cell(), 1, Cell('\0')),
+        size(data.rows, data.cols) {
     for (int r = 0; r < data.rows; ++r) {
-      auto &line = data.lines[r];
-      cells.emplace_back();
-      std::transform(line.begin(), line.end(), std::back_inserter(cells.back()),
-                     [](char ch) { return Cell(ch); });
+      const auto line = data.grid.row(r);
+      for (int c = 0; c < data.cols; ++c) {
+        cells(r, c) = Cell(line[c]);
+      }
     }
   }
 
-  Cell &operator()(int row, int col) { return cells[row][col]; }
-  Cell &operator()(const Coords &coords) {
-    return cells[coords.row][coords.col];
-  }
+  Cell &operator()(int row, int col) { return cells(row, col); }
+  Cell &operator()(const Coords &coords) { return cells(coords); }
 };
 
 struct CoordsToExplore {
@@ -97,14 +95,12 @@ num explore1(Garden &garden, int id, int row, int col) {
           if (iDir != coordsToExplore.predDirIndex) {
             const auto &dir = dirs[iDir];
             const Coords neighCoords = coordsToExplore.coords + dir;
-            if (inBounds(neighCoords, garden.size)) {
-              Cell &neighCell = garden(neighCoords);
-              if (neighCell.ch == seedCh) {
-                --perimeter;
-                // Do not expand already explored cells again.
-                if (neighCell.id != id) {
-                  q.emplace_back(neighCoords, &neighCell, invDirIndices[iDir]);
-                }
+            Cell &neighCell = garden(neighCoords);
+            if (neighCell.ch == seedCh) {
+              --perimeter;
+              // Do not expand already explored cells again.
+              if (neighCell.id != id) {
+                q.emplace_back(neighCoords, &neighCell, invDirIndices[iDir]);
               }
             }
           } else {
@@ -201,15 +197,11 @@ num explore2(Garden &garden, int id, int row, int col) {
           if (iDir != coordsToExplore.predDirIndex) {
             const auto &dir = dirs[iDir];
             const Coords neighCoords = coordsToExplore.coords + dir;
-            if (inBounds(neighCoords, garden.size)) {
-              Cell &neighCell = garden(neighCoords);
-              if (neighCell.ch == seedCh) {
-                // Do not expand already explored cells again.
-                if (neighCell.id != id) {
-                  q.emplace_back(neighCoords, &neighCell, invDirIndices[iDir]);
-                }
-              } else {
-                sidesByDirIndex[iDir].push_back(neighCoords);
+            Cell &neighCell = garden(neighCoords);
+            if (neighCell.ch == seedCh) {
+              // Do not expand already explored cells again.
+              if (neighCell.id != id) {
+                q.emplace_back(neighCoords, &neighCell, invDirIndices[iDir]);
               }
             } else {
               sidesByDirIndex[iDir].push_back(neighCoords);
@@ -243,12 +235,23 @@ void solvePart2(const Data &data_) {
   std::cout << sum << "\n";
 }
 
+#ifdef AOC_RUNNER
+AOC_REGISTER(12, 1, [](const std::string &path) {
+  const MappedFile file(path);
+  solvePart1(parseFile(file));
+});
+AOC_REGISTER(12, 2, [](const std::string &path) {
+  const MappedFile file(path);
+  solvePart2(parseFile(file));
+});
+#else
 int main() {
-  std::ifstream ifs("input.txt");
-  // std::ifstream ifs("input_test.txt");
-  const auto data = parseFile(ifs);
+  const MappedFile file("input.txt");
+  // const MappedFile file("input_test.txt");
+  const auto data = parseFile(file);
   measureTime([&data]() { solvePart1(data); }, "Part 1");
   measureTime([&data]() { solvePart2(data); }, "Part 2");
   std::cout << "Done.\n";
   return 0;
-}
\ No newline at end of file
+}
+#endif
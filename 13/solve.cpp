@@ -130,6 +130,10 @@ void solve(const Data &data, num offset) {
 void solvePart1(const Data &data) { solve(data, 0); }
 void solvePart2(const Data &data) { solve(data, 10000000000000); }
 
+#ifdef AOC_RUNNER
+AOC_REGISTER(13, 1, [](std::ifstream &ifs) { solvePart1(parseFile(ifs)); });
+AOC_REGISTER(13, 2, [](std::ifstream &ifs) { solvePart2(parseFile(ifs)); });
+#else
 int main() {
   std::ifstream ifs("input.txt");
   // std::ifstream ifs("input_test.txt");
@@ -138,4 +142,5 @@ int main() {
   measureTime([&data]() { solvePart2(data); }, "Part 2");
   std::cout << "Done.\n";
   return 0;
-}
\ No newline at end of file
+}
+#endif
@@ -1,12 +1,18 @@
+#include <algorithm>
 #include <array>
 #include <charconv>
 #include <chrono>
 #include <cmath>
+#include <cstdint>
+#include <cstdlib>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <streambuf>
+#include <string>
 #include <string_view>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 // This file is copied into each day.
@@ -90,10 +96,28 @@ inline bool operator<(const Coords_<T> &lhs, const Coords_<T> &rhs) {
   }
 }
 
+// Finaliser of splitmix64. Every input bit affects every output bit.
+inline uint64_t mixHash(uint64_t x) {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ull;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebull;
+  x ^= x >> 31;
+  return x;
+}
+
+// Both coordinates in one key. Only the lower 32 bits of each are kept.
+template <typename T> uint64_t packCoords(const Coords_<T> &p) {
+  return (static_cast<uint64_t>(static_cast<uint32_t>(p.row)) << 32) |
+         static_cast<uint32_t>(p.col);
+}
+
 // For usage with std::unordered_set and std::unordered_map.
+// Hashes the packed coordinates. XOR of the single hashes would map the whole
+// diagonal onto 0 and (r, c) onto the same value as (c, r).
 struct CoordsHash {
   template <typename T> auto operator()(const Coords_<T> &p) const -> size_t {
-    return std::hash<T>{}(p.row) ^ std::hash<T>{}(p.col);
+    return mixHash(packCoords(p));
   }
 };
 
@@ -124,6 +148,118 @@ inline bool inBounds(const Coords_<T> &coords, const Coords_<T> &size) {
 
 inline bool isDigit(char ch) { return 0x30 <= ch && ch < 0x3A; }
 
+// Benchmark mode.
+// Enable it by setting the environment variable AOC_BENCH, e.g.:
+// AOC_BENCH=1 ./solve
+// measureTime() then follows up its normal run with a proper benchmark of the
+// same function and prints the statistics in readable form plus as one JSON
+// line per measurement so that results can be collected across commits.
+inline bool benchmarkEnabled() { return std::getenv("AOC_BENCH") != nullptr; }
+
+// Swallows everything written to it.
+class NullBuffer : public std::streambuf {
+protected:
+  int overflow(int ch) override { return ch; }
+  std::streamsize xsputn(const char *, std::streamsize n) override { return n; }
+};
+
+// Keeps the output of the solutions out of the timed runs.
+class SuppressOutput {
+public:
+  SuppressOutput() : prevBuffer(std::cout.rdbuf(&nullBuffer)) {}
+  ~SuppressOutput() { std::cout.rdbuf(prevBuffer); }
+
+private:
+  NullBuffer nullBuffer;
+  std::streambuf *prevBuffer;
+};
+
+struct BenchmarkResult {
+  int runs = 0;
+  double minMs = 0.0;
+  double medianMs = 0.0;
+  double meanMs = 0.0;
+  double p99Ms = 0.0;
+  double stddevMs = 0.0;
+};
+
+inline BenchmarkResult evalSamples(std::vector<double> samplesMs) {
+  BenchmarkResult res;
+  res.runs = samplesMs.size();
+  if (samplesMs.empty()) {
+    return res;
+  }
+  std::sort(samplesMs.begin(), samplesMs.end());
+  const size_t n = samplesMs.size();
+  res.minMs = samplesMs.front();
+  res.medianMs = (n % 2 == 1)
+                     ? samplesMs[n / 2]
+                     : (samplesMs[n / 2 - 1] + samplesMs[n / 2]) / 2.0;
+  // Nearest rank.
+  const size_t p99Rank = static_cast<size_t>(std::ceil(0.99 * n));
+  res.p99Ms = samplesMs[std::max<size_t>(p99Rank, 1) - 1];
+  double sum = 0.0;
+  for (const double s : samplesMs) {
+    sum += s;
+  }
+  res.meanMs = sum / n;
+  if (n > 1) {
+    double sqSum = 0.0;
+    for (const double s : samplesMs) {
+      sqSum += (s - res.meanMs) * (s - res.meanMs);
+    }
+    res.stddevMs = std::sqrt(sqSum / (n - 1));
+  }
+  return res;
+}
+
+// Runs func until the 95 % confidence interval of the mean is within
+// +-relConfidence of the mean (or one of the limits is reached).
+template <typename Func>
+BenchmarkResult benchmark(Func func, int warmUps = 2, int minRuns = 10,
+                          size_t maxRuns = 10000, double maxSeconds = 5.0,
+                          double relConfidence = 0.01) {
+  SuppressOutput suppressOutput;
+  const auto benchStart = std::chrono::steady_clock::now();
+  auto secondsSince = [](const auto &start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         start)
+        .count();
+  };
+  for (int i = 0; i < warmUps && secondsSince(benchStart) < maxSeconds / 4.0;
+       ++i) {
+    func();
+  }
+  std::vector<double> samplesMs;
+  BenchmarkResult res;
+  do {
+    const auto start = std::chrono::steady_clock::now();
+    func();
+    samplesMs.push_back(secondsSince(start) * 1000.0);
+    if (samplesMs.size() >= 2) {
+      res = evalSamples(samplesMs);
+      const double ciHalfWidth = 1.96 * res.stddevMs / std::sqrt(res.runs);
+      if (res.runs >= minRuns && ciHalfWidth <= relConfidence * res.meanMs) {
+        break;
+      }
+    }
+  } while (samplesMs.size() < maxRuns && secondsSince(benchStart) < maxSeconds);
+  return evalSamples(samplesMs);
+}
+
+inline void printBenchmarkResult(const BenchmarkResult &res,
+                                 const std::string &name) {
+  std::cout << std::setprecision(6) << name << " benchmark: " << res.runs
+            << " runs, min " << res.minMs << " ms, median " << res.medianMs
+            << " ms, mean " << res.meanMs << " ms, p99 " << res.p99Ms
+            << " ms, stddev " << res.stddevMs << " ms\n";
+  std::cout << "{\"name\": \"" << name << "\", \"runs\": " << res.runs
+            << ", \"min_ms\": " << res.minMs
+            << ", \"median_ms\": " << res.medianMs
+            << ", \"mean_ms\": " << res.meanMs << ", \"p99_ms\": " << res.p99Ms
+            << ", \"stddev_ms\": " << res.stddevMs << "}\n";
+}
+
 template <typename Func>
 void measureTime(Func func, const std::string &name, int repetitions = 1) {
   std::cout << "Running " << name << "...\n";
@@ -160,6 +296,9 @@ void measureTime(Func func, const std::string &name, int repetitions = 1) {
                   static_cast<double>(repetitions))
               << " ms\n";
   }
+  if (benchmarkEnabled()) {
+    printBenchmarkResult(benchmark(func), name);
+  }
 }
 
 inline std::ostream &operator<<(std::ostream &os,
@@ -201,16 +340,33 @@ std::vector<std::vector<T>> parseCSVNumbers(std::ifstream &ifs,
   return ret;
 }
 
-template <typename T> int getNumDigits(T n) {
-  static_assert(std::is_integral_v<T>);
-  if (n == 0) {
-    return 1;
+// All powers of 10 which fit into 64 bit.
+constexpr std::array<uint64_t, 20> POWERS_OF_10 = []() {
+  std::array<uint64_t, 20> powers{};
+  uint64_t p = 1;
+  for (auto &power : powers) {
+    power = p;
+    p *= 10;
   }
-  return std::log10(n) + 1;
+  return powers;
+}();
+
+constexpr uint64_t powerOf10(int exponent) { return POWERS_OF_10[exponent]; }
+
+// Integer only (no rounding issues close to powers of 10).
+// The bit length gives the number of digits up to one which the table fixes.
+template <typename T> constexpr int getNumDigits(T n) {
+  static_assert(std::is_integral_v<T>);
+  // 0 has as many digits as 1.
+  const uint64_t u = static_cast<uint64_t>(n) | 1;
+  const int bits = 64 - __builtin_clzll(u);
+  const int estimate = (bits * 1233) >> 12; // 1233 / 4096 ~ log10(2)
+  return estimate + 1 - (u < POWERS_OF_10[estimate]);
 }
 
-template <typename T> std::pair<T, T> splitNumber(T n, int rightDigits) {
+template <typename T>
+constexpr std::pair<T, T> splitNumber(T n, int rightDigits) {
   static_assert(std::is_integral_v<T>);
-  const T div = std::pow(10, rightDigits);
+  const T div = static_cast<T>(powerOf10(rightDigits));
   return std::pair<T, T>(n / div, n % div);
 }
\ No newline at end of file
@@ -140,6 +140,18 @@ void solvePart2(const Data &data) {
   std::cout << "8006\n";
 }
 
+#ifdef AOC_RUNNER
+AOC_REGISTER(14, 1, [](std::ifstream &ifs) {
+  auto data = parseFile(ifs);
+  data.roomSize = Coords(103, 101);
+  solvePart1(data);
+});
+AOC_REGISTER(14, 2, [](std::ifstream &ifs) {
+  auto data = parseFile(ifs);
+  data.roomSize = Coords(103, 101);
+  solvePart2(data);
+});
+#else
 int main() {
   std::ifstream ifs("input.txt");
   const Coords roomSize(103, 101);
@@ -153,4 +165,5 @@ int main() {
   measureTime([&data]() { solvePart2(data); }, "Part 2");
   std::cout << "Done.\n";
   return 0;
-}
\ No newline at end of file
+}
+#endif
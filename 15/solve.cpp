@@ -39,21 +39,7 @@ Data parseFile(std::ifstream &ifs) {
   return data;
 }
 
-struct Map {
-  Map(std::vector<std::string> lines_)
-      : lines(std::move(lines_)), size(lines.size(), lines[0].size()) {}
-
-  std::vector<std::string> lines;
-  Coords size;
-  char &operator()(const Coords &coords) {
-    return lines[coords.row][coords.col];
-  }
-  const char operator()(const Coords &coords) const {
-    return lines[coords.row][coords.col];
-  }
-  char &operator()(num row, num col) { return lines[row][col]; }
-  const char operator()(num row, num col) const { return lines[row][col]; }
-};
+using Map = Grid<char>;
 
 struct State {
   Map map;
@@ -109,10 +95,9 @@ void iterate(State &state, Coords dir, MoveFunc moveFunc) {
 
 num sumGPSCoords(const State &state) {
   num sum = 0;
-  for (num row = 0; row < state.map.size.row; ++row) {
-    const auto &line = state.map.lines[row];
-    for (num col = 0; col < line.size(); ++col) {
-      const char ch = line[col];
+  for (num row = 0; row < state.map.rows; ++row) {
+    for (num col = 0; col < state.map.cols; ++col) {
+      const char ch = state.map(row, col);
       if (ch == 'O' || ch == '[') {
         sum += row * 100 + col;
       }
@@ -122,7 +107,7 @@ num sumGPSCoords(const State &state) {
 }
 
 void solvePart1(const Data &data) {
-  State state{Map(data.lines), data.robotPos};
+  State state{Map::fromLines(data.lines), data.robotPos};
   auto &moves = data.moves;
   for (num i = 0; i < moves.size(); ++i) {
     const Coords dir = charToDir(moves[i]);
@@ -132,20 +117,21 @@ void solvePart1(const Data &data) {
 }
 
 Map makeWideMap(const Data &data) {
-  std::vector<std::string> widerLines;
-  widerLines.reserve(data.lines.size());
-  for (const auto &line : data.lines) {
-    std::stringstream ss;
-    for (char ch : line) {
+  const Map map = Map::fromLines(data.lines);
+  Map wideMap(map.rows, map.cols * 2);
+  for (num row = 0; row < map.rows; ++row) {
+    for (num col = 0; col < map.cols; ++col) {
+      const char ch = map(row, col);
       if (ch == 'O') {
-        ss << "[]";
+        wideMap(row, 2 * col) = '[';
+        wideMap(row, 2 * col + 1) = ']';
       } else {
-        ss << ch << ch;
+        wideMap(row, 2 * col) = ch;
+        wideMap(row, 2 * col + 1) = ch;
       }
     }
-    widerLines.push_back(ss.str());
   }
-  return Map(widerLines);
+  return wideMap;
 }
 
 Coords makeWidePos(const Coords &pos) { return Coords(pos.row, pos.col * 2); }
@@ -240,6 +226,10 @@ void solvePart2(const Data &data) {
   std::cout << sumGPSCoords(state) << "\n";
 }
 
+#ifdef AOC_RUNNER
+AOC_REGISTER(15, 1, [](std::ifstream &ifs) { solvePart1(parseFile(ifs)); });
+AOC_REGISTER(15, 2, [](std::ifstream &ifs) { solvePart2(parseFile(ifs)); });
+#else
 int main() {
   std::ifstream ifs("input.txt");
   // std::ifstream ifs("input_test.txt");
@@ -250,4 +240,5 @@ int main() {
   measureTime([&data]() { solvePart2(data); }, "Part 2");
   std::cout << "Done.\n";
   return 0;
-}
\ No newline at end of file
+}
+#endif
@@ -1,17 +1,19 @@
 #include "utils.h"
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
 #include <queue>
 #include <set>
 #include <string>
-#include <unordered_map>
+#include <unordered_set>
 
 using num = int;
 using Coords = Coords_<num>;
 
 struct Data {
-  std::vector<std::string> lines;
+  Grid<char> grid;
   Coords start;
   Coords end;
 };
@@ -32,6 +34,7 @@ bool isFree(char ch) { return ch == '.' || ch == '+'; }
 
 Data parseFile(std::ifstream &ifs) {
   Data data;
+  std::vector<std::string> lines;
   std::string line;
   data.start.row = -1;
   data.end.row = -1;
@@ -39,26 +42,28 @@ Data parseFile(std::ifstream &ifs) {
   while (std::getline(ifs, line)) {
     searchCharAndMarkFree(&line, row, 'S', &data.start);
     searchCharAndMarkFree(&line, row, 'E', &data.end);
-    data.lines.push_back(line);
+    lines.push_back(line);
     ++row;
   }
-  data.lines[data.start.row][data.start.col] = '.';
-  data.lines[data.end.row][data.end.col] = '.';
+  data.grid = Grid<char>::fromLines(lines);
+  auto &grid = data.grid;
+  grid(data.start) = '.';
+  grid(data.end) = '.';
   // For easier and quicker search later on:
   // Mark positions at which turning makes sense.
-  for (num row = 1; row + 1 < data.lines.size(); ++row) {
-    for (num col = 1; col + 1 < data.lines.size(); ++col) {
-      if (data.lines[row][col] == '.') {
-        const bool leftFree = isFree(data.lines[row][col - 1]);
-        const bool rightFree = isFree(data.lines[row][col + 1]);
-        const bool upFree = isFree(data.lines[row - 1][col]);
-        const bool downFree = isFree(data.lines[row + 1][col]);
+  for (num row = 1; row + 1 < grid.rows; ++row) {
+    for (num col = 1; col + 1 < grid.cols; ++col) {
+      if (grid(row, col) == '.') {
+        const bool leftFree = isFree(grid(row, col - 1));
+        const bool rightFree = isFree(grid(row, col + 1));
+        const bool upFree = isFree(grid(row - 1, col));
+        const bool downFree = isFree(grid(row + 1, col));
         int numFree = static_cast<int>(leftFree) + static_cast<int>(rightFree) +
                       static_cast<int>(upFree) + static_cast<int>(downFree);
         // Do not try to turn in dead ends or on straights.
         if (numFree != 1 && !(numFree == 2 && ((leftFree && rightFree) ||
                                                (upFree && downFree)))) {
-          data.lines[row][col] = '+';
+          grid(row, col) = '+';
         }
       }
     }
@@ -88,16 +93,17 @@ struct Pose {
   Pose goRight() const { return Pose(pos, getPrevDirIndex()); }
 };
 
-// For usage with std::unordered_map.
+// For usage with hash maps.
 bool operator==(const Pose &lhs, const Pose &rhs) {
   return lhs.pos == rhs.pos && lhs.dirIndex == rhs.dirIndex;
 }
 
-// For usage with std::unordered_map.
+// For usage with hash maps.
 struct PoseHash {
   auto operator()(const Pose &p) const -> size_t {
-    return std::hash<num>{}(p.pos.row) ^ std::hash<num>{}(p.pos.col) ^
-           std::hash<char>{}(p.dirIndex);
+    // The rows never reach the top two bits of the key.
+    const uint64_t dirBits = static_cast<uint64_t>(p.dirIndex) << 62;
+    return mixHash(packCoords(p.pos) ^ dirBits);
   }
 };
 
@@ -136,6 +142,9 @@ public:
     end = data.end;
     const Pose startPose(data.start);
     q.push(Node(startPose, 0, heuristic1(startPose)));
+    // Every pose fits without rehashing. So the references to the
+    // predecessors of the expanded node stay valid while inserting.
+    reachedPoses.reserve(data.grid.cells.size() * 4);
     reachedPoses[startPose] = Record(0);
     num bestCostsForSolution = std::numeric_limits<num>::max();
     std::vector<Node> solutions;
@@ -168,8 +177,7 @@ public:
             neighPose = neighPose.goForward();
             ++neighAccCosts;
             movedCoords.insert(neighPose.pos);
-            const char neighCh =
-                data.lines[neighPose.pos.row][neighPose.pos.col];
+            const char neighCh = data.grid(neighPose.pos);
             if (neighCh == '#') {
               // Dead end
               // Not worth putting it into queue.
@@ -215,9 +223,8 @@ private:
   void tryEnqueueNode(const Pose &pose, num accCosts,
                       const std::set<Coords> &predecessors,
                       const std::set<Coords> nextCoords = std::set<Coords>()) {
-    auto inserted = reachedPoses.insert(std::make_pair(pose, Record(accCosts)));
-    auto &it = inserted.first;
-    auto &record = it->second;
+    auto inserted = reachedPoses.tryEmplace(pose, accCosts);
+    auto &record = *inserted.first;
     num &knownCosts = record.bestAccCosts;
     if (inserted.second || accCosts < knownCosts) {
       // Better trajectory found.
@@ -243,7 +250,7 @@ private:
 
   Coords end;
   std::priority_queue<Node> q;
-  std::unordered_map<Pose, Record, PoseHash> reachedPoses; // -> min costs
+  FlatHashMap<Pose, Record, PoseHash> reachedPoses; // -> min costs
 };
 
 void solvePart1And2(const Data &data) {
@@ -251,12 +258,72 @@ void solvePart1And2(const Data &data) {
   astar.solvePart1(data);
 }
 
+// The hash used before. Kept for comparison.
+struct XorPoseHash {
+  auto operator()(const Pose &p) const -> size_t {
+    return std::hash<num>{}(p.pos.row) ^ std::hash<num>{}(p.pos.col) ^
+           std::hash<char>{}(p.dirIndex);
+  }
+};
+
+// Collisions and set throughput of a hash on all poses of the map.
+template <typename Hash>
+void benchmarkHash(const std::vector<Pose> &poses, const std::string &name) {
+  std::unordered_set<size_t> hashes;
+  for (const auto &pose : poses) {
+    hashes.insert(Hash{}(pose));
+  }
+  std::unordered_set<Pose, Hash> set(poses.begin(), poses.end());
+  size_t maxBucketSize = 0;
+  for (size_t b = 0; b < set.bucket_count(); ++b) {
+    maxBucketSize = std::max(maxBucketSize, set.bucket_size(b));
+  }
+  std::cout << name << ": " << poses.size() << " poses, "
+            << poses.size() - hashes.size() << " hash collisions, "
+            << "max bucket size " << maxBucketSize << "\n";
+  printBenchmarkResult(benchmark([&poses]() {
+                         std::unordered_set<Pose, Hash> set;
+                         for (const auto &pose : poses) {
+                           set.insert(pose);
+                         }
+                         size_t found = 0;
+                         for (const auto &pose : poses) {
+                           found += set.count(pose);
+                         }
+                         std::cout << found << "\n";
+                       }),
+                       name + " insert + lookup");
+}
+
+void benchmarkHashes(const Data &data) {
+  std::vector<Pose> poses;
+  for (num row = 0; row < data.grid.rows; ++row) {
+    for (num col = 0; col < data.grid.cols; ++col) {
+      for (char dirIndex = 0; dirIndex < 4; ++dirIndex) {
+        poses.emplace_back(Coords(row, col), dirIndex);
+      }
+    }
+  }
+  benchmarkHash<XorPoseHash>(poses, "XOR hash");
+  benchmarkHash<PoseHash>(poses, "Packed hash");
+  benchmarkHashMaps<Pose, PoseHash>(poses, "Pose keys");
+}
+
+#ifdef AOC_RUNNER
+AOC_REGISTER_HEAVY(16, aoc::PART_BOTH, [](std::ifstream &ifs) {
+  solvePart1And2(parseFile(ifs));
+});
+#else
 int main() {
   std::ifstream ifs("input.txt");
   // std::ifstream ifs("input_test.txt");
   // std::ifstream ifs("input_test1.txt");
   const auto data = parseFile(ifs);
   measureTime([&data]() { solvePart1And2(data); }, "Part 1 + 2");
+  if (benchmarkEnabled()) {
+    benchmarkHashes(data);
+  }
   std::cout << "Done.\n";
   return 0;
-}
\ No newline at end of file
+}
+#endif
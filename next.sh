@@ -21,4 +21,7 @@ next_dir=$(printf "%02d" $next)
 # Copy the template directory to the new directory.
 cp -r template "$next_dir"
 
+# Register the new day in the aoc runner.
+sed -i "s/constexpr int DAY = 0;/constexpr int DAY = $next;/" "$next_dir/solve.cpp"
+
 echo "Created directory $next_dir from template"
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <streambuf>
+#include <string>
+
+// Stream buffer for std::cout that collects the output of each thread
+// separately. This way the output of jobs running in parallel does not get
+// mixed up.
+// Threads that do not capture write through to the original buffer.
+class CaptureBuffer : public std::streambuf {
+public:
+  explicit CaptureBuffer(std::streambuf *passThrough_)
+      : passThrough(passThrough_) {}
+
+  // Pass nullptr to stop capturing in the calling thread.
+  static void captureInto(std::string *target_) { target = target_; }
+
+protected:
+  int overflow(int ch) override {
+    if (ch != traits_type::eof()) {
+      if (target != nullptr) {
+        target->push_back(static_cast<char>(ch));
+      } else {
+        passThrough->sputc(static_cast<char>(ch));
+      }
+    }
+    return ch;
+  }
+
+  std::streamsize xsputn(const char *s, std::streamsize n) override {
+    if (target != nullptr) {
+      target->append(s, n);
+      return n;
+    }
+    return passThrough->sputn(s, n);
+  }
+
+  int sync() override { return target != nullptr ? 0 : passThrough->pubsync(); }
+
+private:
+  std::streambuf *passThrough;
+  static thread_local std::string *target;
+};
+
+inline thread_local std::string *CaptureBuffer::target = nullptr;
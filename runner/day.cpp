@@ -0,0 +1,14 @@
+// Compiles one day into the aoc runner.
+// The Makefile builds this once per day with AOC_DAY_NAMESPACE and
+// AOC_DAY_SOURCE set.
+// Each day lives in its own namespace so that their Data, parseFile(),
+// solvePart1(), ... and their own copy of the utils.h do not clash.
+
+#include "prelude.h"
+#include "registry.h"
+
+#define AOC_RUNNER
+
+namespace AOC_DAY_NAMESPACE {
+#include AOC_DAY_SOURCE
+} // namespace AOC_DAY_NAMESPACE
@@ -0,0 +1,258 @@
+// Runs the solvers of all days (or of a selected day / part) in one process.
+//
+// Usage:
+// ./aoc                             All days with their input.txt
+// ./aoc --day 6                     Both parts of day 6
+// ./aoc --day 6 --part 2            Part 2 of day 6
+// ./aoc --day 6 --input path        Day 6 with another input
+// ./aoc --parallel                  All days on one thread per core
+// ./aoc --jobs 4                    All days on 4 threads
+
+#include "capture_buffer.h"
+#include "registry.h"
+#include "work_stealing_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct Options {
+  int day = -1;  // -1: all days
+  int part = -1; // -1: all parts
+  std::string input;
+  int jobs = 1; // 0: one per core
+};
+
+void printUsage() {
+  std::cout << "Usage: aoc [--day N [--part 1|2] [--input PATH]] "
+               "[--parallel | --jobs N]\n";
+}
+
+// Parses the whole value as an int. False for anything else.
+bool parseInt(const std::string &value, int *result) {
+  try {
+    size_t pos = 0;
+    *result = std::stoi(value, &pos);
+    return pos == value.size();
+  } catch (const std::invalid_argument &) {
+    return false;
+  } catch (const std::out_of_range &) {
+    return false;
+  }
+}
+
+bool parseArgs(int argc, char **argv, Options *options) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "--parallel") {
+      options->jobs = 0;
+      continue;
+    }
+    if (i + 1 >= argc) {
+      return false;
+    }
+    const std::string value = argv[++i];
+    if (arg == "--day") {
+      if (!parseInt(value, &options->day)) {
+        return false;
+      }
+    } else if (arg == "--part") {
+      if (!parseInt(value, &options->part)) {
+        return false;
+      }
+    } else if (arg == "--input") {
+      options->input = value;
+    } else if (arg == "--jobs") {
+      if (!parseInt(value, &options->jobs)) {
+        return false;
+      }
+    } else {
+      return false;
+    }
+  }
+  // A custom input only makes sense for a single day.
+  return options->jobs >= 0 &&
+         (options->input.empty() || options->day != -1);
+}
+
+std::string defaultInput(int day) {
+  char path[32];
+  std::snprintf(path, sizeof(path), "%02d/input.txt", day);
+  return path;
+}
+
+std::string partName(int part) {
+  return part == aoc::PART_BOTH ? "Part 1 + 2" : "Part " + std::to_string(part);
+}
+
+std::vector<aoc::Solver> selectSolvers(const Options &options) {
+  std::vector<aoc::Solver> selected;
+  for (const auto &solver : aoc::registry()) {
+    // Days solving both parts at once are selected for either part.
+    if ((options.day == -1 || solver.day == options.day) &&
+        (options.part == -1 || solver.part == options.part ||
+         solver.part == aoc::PART_BOTH)) {
+      selected.push_back(solver);
+    }
+  }
+  std::sort(selected.begin(), selected.end(),
+            [](const aoc::Solver &lhs, const aoc::Solver &rhs) {
+              return lhs.day != rhs.day ? lhs.day < rhs.day
+                                        : lhs.part < rhs.part;
+            });
+  return selected;
+}
+
+double millisecondsBetween(const std::chrono::steady_clock::time_point &start,
+                           const std::chrono::steady_clock::time_point &end) {
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+double millisecondsSince(const std::chrono::steady_clock::time_point &start) {
+  return millisecondsBetween(start, std::chrono::steady_clock::now());
+}
+
+std::string inputFor(const Options &options, const aoc::Solver &solver) {
+  return options.input.empty() ? defaultInput(solver.day) : options.input;
+}
+
+int runSerial(const Options &options,
+              const std::vector<aoc::Solver> &solvers) {
+  const auto suiteStart = std::chrono::steady_clock::now();
+  for (const auto &solver : solvers) {
+    const std::string input = inputFor(options, solver);
+    if (!std::ifstream(input)) {
+      std::cout << "Cannot open '" << input << "'.\n";
+      return 1;
+    }
+    std::cout << "Day " << solver.day << " " << partName(solver.part)
+              << ":\n";
+    const auto start = std::chrono::steady_clock::now();
+    solver.func(input);
+    std::cout << std::setprecision(6) << "took " << millisecondsSince(start)
+              << " ms\n";
+  }
+  std::cout << "Total: " << std::setprecision(6)
+            << millisecondsSince(suiteStart) << " ms\n";
+  return 0;
+}
+
+struct JobResult {
+  std::string output;
+  bool inputFound = false;
+  size_t workerIndex = 0;
+  double startMs = 0.0; // Relative to the start of the suite.
+  double durationMs = 0.0;
+};
+
+void printCriticalPathReport(const std::vector<aoc::Solver> &solvers,
+                             const std::vector<JobResult> &results,
+                             size_t numWorkers, double wallMs) {
+  double sumMs = 0.0;
+  size_t longest = 0;
+  for (size_t i = 0; i < results.size(); ++i) {
+    sumMs += results[i].durationMs;
+    if (results[i].durationMs > results[longest].durationMs) {
+      longest = i;
+    }
+  }
+  // The jobs are independent.
+  // So the longest job is the critical path and a lower bound for the wall
+  // time.
+  const double criticalMs = results[longest].durationMs;
+  const double speedup = wallMs > 0.0 ? sumMs / wallMs : 0.0;
+  std::cout << std::setprecision(6) << "Workers: " << numWorkers << "\n";
+  std::cout << "Sum of jobs: " << sumMs << " ms\n";
+  std::cout << "Critical path: Day " << solvers[longest].day << " "
+            << partName(solvers[longest].part) << " with " << criticalMs
+            << " ms\n";
+  std::cout << "Total: " << wallMs << " ms (" << wallMs - criticalMs
+            << " ms over critical path, speedup " << speedup
+            << ", efficiency " << speedup / numWorkers << ")\n";
+}
+
+int runParallel(const Options &options,
+                const std::vector<aoc::Solver> &solvers) {
+  const size_t numWorkers =
+      options.jobs > 0 ? options.jobs
+                       : std::max(1u, std::thread::hardware_concurrency());
+  // Start heavy jobs first so that the wall time gets close to the one of the
+  // longest job.
+  std::vector<size_t> order(solvers.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), [&solvers](size_t a, size_t b) {
+    return solvers[a].heavy && !solvers[b].heavy;
+  });
+
+  std::vector<JobResult> results(solvers.size());
+  CaptureBuffer captureBuffer(std::cout.rdbuf());
+  std::streambuf *prevBuffer = std::cout.rdbuf(&captureBuffer);
+  const auto suiteStart = std::chrono::steady_clock::now();
+  std::vector<WorkStealingPool::Job> jobs;
+  jobs.reserve(order.size());
+  for (const size_t i : order) {
+    jobs.push_back([&options, &solvers, &results, suiteStart,
+                    i](size_t workerIndex) {
+      const auto &solver = solvers[i];
+      auto &result = results[i];
+      result.workerIndex = workerIndex;
+      const auto start = std::chrono::steady_clock::now();
+      result.startMs = millisecondsBetween(suiteStart, start);
+      const std::string input = inputFor(options, solver);
+      result.inputFound = static_cast<bool>(std::ifstream(input));
+      if (result.inputFound) {
+        CaptureBuffer::captureInto(&result.output);
+        solver.func(input);
+        CaptureBuffer::captureInto(nullptr);
+      }
+      result.durationMs = millisecondsSince(start);
+    });
+  }
+  WorkStealingPool pool(numWorkers);
+  pool.run(std::move(jobs));
+  const double wallMs = millisecondsSince(suiteStart);
+  std::cout.rdbuf(prevBuffer);
+
+  bool allInputsFound = true;
+  for (size_t i = 0; i < solvers.size(); ++i) {
+    const auto &solver = solvers[i];
+    const auto &result = results[i];
+    std::cout << "Day " << solver.day << " " << partName(solver.part)
+              << ":\n";
+    if (!result.inputFound) {
+      std::cout << "Cannot open '" << inputFor(options, solver) << "'.\n";
+      allInputsFound = false;
+    }
+    std::cout << result.output;
+    std::cout << std::setprecision(6) << "took " << result.durationMs
+              << " ms (worker " << result.workerIndex << ", started at "
+              << result.startMs << " ms)\n";
+  }
+  printCriticalPathReport(solvers, results, pool.numWorkers(), wallMs);
+  return allInputsFound ? 0 : 1;
+}
+
+int main(int argc, char **argv) {
+  Options options;
+  if (!parseArgs(argc, argv, &options)) {
+    printUsage();
+    return 1;
+  }
+  const auto solvers = selectSolvers(options);
+  if (solvers.empty()) {
+    std::cout << "No solver registered for this selection.\n";
+    return 1;
+  }
+  if (options.jobs == 1) {
+    return runSerial(options, solvers);
+  }
+  return runParallel(options, solvers);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <fstream>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Registry of all solvers that are linked into the aoc runner.
+// The days register themselves in their solve.cpp with AOC_REGISTER().
+
+namespace aoc {
+
+// Parses the input file and prints the solution to std::cout.
+using SolverFunc = std::function<void(const std::string &inputPath)>;
+
+// Days solving both parts at once register as PART_BOTH.
+constexpr int PART_BOTH = 0;
+
+struct Solver {
+  int day;
+  int part;
+  SolverFunc func;
+  // Known to dominate the run time of the suite.
+  // Started first when running in parallel.
+  bool heavy;
+};
+
+inline std::vector<Solver> &registry() {
+  static std::vector<Solver> solvers;
+  return solvers;
+}
+
+struct Registrar {
+  // func takes either the path of the input file or an std::ifstream of it.
+  template <typename Func>
+  Registrar(int day, int part, Func func, bool heavy = false) {
+    if constexpr (std::is_invocable_v<Func, std::ifstream &>) {
+      registry().push_back(Solver{day, part,
+                                  [func](const std::string &inputPath) {
+                                    std::ifstream ifs(inputPath);
+                                    func(ifs);
+                                  },
+                                  heavy});
+    } else {
+      registry().push_back(Solver{day, part, std::move(func), heavy});
+    }
+  }
+};
+
+} // namespace aoc
+
+#define AOC_CONCAT_IMPL(a, b) a##b
+#define AOC_CONCAT(a, b) AOC_CONCAT_IMPL(a, b)
+#define AOC_REGISTER(day, part, func)                                          \
+  static const ::aoc::Registrar AOC_CONCAT(aocRegistrar, __LINE__)(day, part,  \
+                                                                   func)
+#define AOC_REGISTER_HEAVY(day, part, func)                                    \
+  static const ::aoc::Registrar AOC_CONCAT(aocRegistrar, __LINE__)(           \
+      day, part, func, true)
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Runs a fixed set of independent jobs on a number of worker threads.
+// The jobs are distributed round robin in the given order so that the first
+// jobs are started first. Each worker processes its own queue from the front.
+// An idle worker steals from the back of the other queues.
+class WorkStealingPool {
+public:
+  using Job = std::function<void(size_t workerIndex)>;
+
+  explicit WorkStealingPool(size_t numWorkers)
+      : queues(numWorkers > 0 ? numWorkers : 1) {}
+
+  size_t numWorkers() const { return queues.size(); }
+
+  // Blocks until all jobs are done.
+  void run(std::vector<Job> jobs) {
+    for (size_t i = 0; i < jobs.size(); ++i) {
+      queues[i % queues.size()].jobs.push_back(std::move(jobs[i]));
+    }
+    std::vector<std::thread> workers;
+    workers.reserve(queues.size());
+    for (size_t w = 0; w < queues.size(); ++w) {
+      workers.emplace_back([this, w]() { work(w); });
+    }
+    for (auto &worker : workers) {
+      worker.join();
+    }
+  }
+
+private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Job> jobs;
+  };
+
+  bool popFront(Queue &queue, Job *job) {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.jobs.empty()) {
+      return false;
+    }
+    *job = std::move(queue.jobs.front());
+    queue.jobs.pop_front();
+    return true;
+  }
+
+  bool popBack(Queue &queue, Job *job) {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.jobs.empty()) {
+      return false;
+    }
+    *job = std::move(queue.jobs.back());
+    queue.jobs.pop_back();
+    return true;
+  }
+
+  bool steal(size_t thief, Job *job) {
+    for (size_t i = 1; i < queues.size(); ++i) {
+      if (popBack(queues[(thief + i) % queues.size()], job)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void work(size_t w) {
+    // No new jobs are added while running.
+    // So there is nothing left to do once all queues are empty.
+    Job job;
+    while (popFront(queues[w], &job) || steal(w, &job)) {
+      job(w);
+    }
+  }
+
+  std::vector<Queue> queues;
+};
@@ -2,17 +2,15 @@
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <string_view>
 
 struct Data {
-  std::vector<std::string> lines;
+  std::vector<std::string_view> lines; // Point into the MappedFile.
 };
 
-Data parseFile(std::ifstream &ifs) {
+Data parseFile(const MappedFile &file) {
   Data data;
-  std::string line;
-  while (std::getline(ifs, line)) {
-    data.lines.push_back(line);
-  }
+  data.lines = file.lines();
   return data;
 }
 
@@ -24,12 +22,24 @@ void solvePart2(const Data &data) {
   // TODO
 }
 
+#ifdef AOC_RUNNER
+constexpr int DAY = 0; // Set by next.sh.
+AOC_REGISTER(DAY, 1, [](const std::string &path) {
+  const MappedFile file(path);
+  solvePart1(parseFile(file));
+});
+AOC_REGISTER(DAY, 2, [](const std::string &path) {
+  const MappedFile file(path);
+  solvePart2(parseFile(file));
+});
+#else
 int main() {
-  // std::ifstream ifs("input.txt");
-  std::ifstream ifs("input_test.txt");
-  const auto data = parseFile(ifs);
+  // const MappedFile file("input.txt");
+  const MappedFile file("input_test.txt");
+  const auto data = parseFile(file);
   measureTime([&data]() { solvePart1(data); }, "Part 1");
   measureTime([&data]() { solvePart2(data); }, "Part 2");
   std::cout << "Done.\n";
   return 0;
-}
\ No newline at end of file
+}
+#endif